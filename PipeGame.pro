@@ -0,0 +1,21 @@
+TEMPLATE = subdirs
+
+SUBDIRS = core \
+    app \
+    tools \
+    bench \
+    tests
+
+core.subdir = pipes/core
+
+app.file = pipes/Pipes.pro
+app.depends = core
+
+tools.subdir = pipes/tools
+tools.depends = core
+
+bench.subdir = pipes/bench
+bench.depends = core
+
+tests.subdir = pipes/tests
+tests.depends = core
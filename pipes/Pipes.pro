@@ -6,24 +6,32 @@
 
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 TARGET = Pipes
 TEMPLATE = app
 CONFIGS += c++11
 
+include(core/core.pri)
+
 SOURCES += main.cpp\
         loginwindow.cpp \
     gameinstance.cpp \
-    block.cpp \
+    blockimages.cpp \
+    boardview.cpp \
+    flowanimation.cpp \
     gamewindow.cpp \
-    recordmanager.cpp
+    recordmanager.cpp \
+    startuptimer.cpp
 
 HEADERS  += loginwindow.h \
     gameinstance.h \
-    block.h \
+    blockimages.h \
+    boardview.h \
+    flowanimation.h \
     gamewindow.h \
-    recordmanager.h
+    recordmanager.h \
+    startuptimer.h
 
 FORMS    += loginwindow.ui \
     gamewindow.ui
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Microbenchmarks of the board kernels
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = pipesbench
+
+include(../core/core.pri)
+
+# The shipped levels, benchmarked by default
+DEFINES += PIPES_MAPS=\\\"$$PWD/../maps/maps.txt\\\"
+
+SOURCES += main.cpp
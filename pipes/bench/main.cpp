@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "batchevaluator.h"
+#include "evaluator.h"
+#include "history.h"
+#include "levelparser.h"
+#include "liveflow.h"
+#include "random.h"
+#include "snapshot.h"
+#include "solver.h"
+#include "swipe.h"
+
+#ifndef PIPES_MAPS
+#define PIPES_MAPS "maps.txt"
+#endif
+
+using namespace std;
+
+// Keeps results alive so the compiler can not drop the measured work
+static volatile long long sink;
+
+struct Benchmark {
+    string name;
+    function<long long()> run;
+    // Boards handled per run, for a throughput column; 0 for none
+    int items;
+
+    Benchmark(const string &_name, const function<long long()> &_run, int _items = 0):
+        name(_name),
+        run(_run),
+        items(_items)
+    {
+    }
+};
+
+struct Result {
+    string name;
+    int items;
+    long long iterations;
+    vector<double> samples;
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double max;
+};
+
+struct Options {
+    int samples;
+    double sampleTime;
+    double warmupTime;
+    string filter;
+    string json;
+};
+
+static double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Warm up, size a batch to take about sampleTime, then time `samples` batches
+static Result measure(const Benchmark &benchmark, const Options &options) {
+    long long batch = 1;
+    chrono::steady_clock::time_point warmup = chrono::steady_clock::now();
+    while (true) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < batch; ++i) sink = sink + benchmark.run();
+        double elapsed = seconds(start);
+        if (elapsed >= options.sampleTime && seconds(warmup) >= options.warmupTime) break;
+        if (elapsed < options.sampleTime) {
+            batch = elapsed > 0 ? max(batch + 1, static_cast<long long>(batch * options.sampleTime / elapsed))
+                                : batch * 10;
+        }
+    }
+
+    Result result;
+    result.name = benchmark.name;
+    result.items = benchmark.items;
+    result.iterations = batch;
+    for (int sample = 0; sample < options.samples; ++sample) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < batch; ++i) sink = sink + benchmark.run();
+        result.samples.push_back(seconds(start) * 1e9 / batch);
+    }
+
+    vector<double> sorted = result.samples;
+    sort(sorted.begin(), sorted.end());
+    result.min = sorted.front();
+    result.max = sorted.back();
+    result.median = sorted.size() % 2 ? sorted[sorted.size() / 2]
+                                      : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+    result.mean = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) result.mean += sorted[i];
+    result.mean /= sorted.size();
+    result.stddev = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) result.stddev += (sorted[i] - result.mean) * (sorted[i] - result.mean);
+    result.stddev = sorted.size() > 1 ? sqrt(result.stddev / (sorted.size() - 1)) : 0;
+    return result;
+}
+
+static bool writeJson(const string &path, const vector<Result> &results, const Options &options) {
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+    fprintf(file, "{\n  \"unit\": \"ns/op\",\n  \"samples\": %d,\n  \"benchmarks\": [", options.samples);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &result = results[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %lld, \"min\": %.3f, \"median\": %.3f, "
+                      "\"mean\": %.3f, \"stddev\": %.3f, \"max\": %.3f",
+                i == 0 ? "" : ",", result.name.c_str(), result.iterations, result.min, result.median,
+                result.mean, result.stddev, result.max);
+        if (result.items > 0) fprintf(file, ", \"items_per_second\": %.0f", result.items * 1e9 / result.median);
+        fputc('}', file);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+// Block type and orientation showing exactly `ends`
+static BlockData blockFor(int ends) {
+    for (int type = 0; type < BlockType::EMPTY; ++type) {
+        for (int orientation = 0; orientation < 4; ++orientation) {
+            if (pipeDirection(static_cast<BlockType>(type), orientation) == ends) {
+                return {static_cast<BlockType>(type), orientation};
+            }
+        }
+    }
+    return {BlockType::EMPTY, 0};
+}
+
+// A solved path through every row but the last two, which it crosses in
+// vertical zigzags, so the water visits all blocks but one in a long line
+static Board serpentine(int size) {
+    vector<pair<int, int> > path;
+    for (int y = 0; y < size - 2; ++y) {
+        for (int i = 0; i < size; ++i) path.push_back(make_pair(y, y % 2 == 0 ? i : size - 1 - i));
+    }
+    for (int x = 0; x < size - 1; ++x) {
+        path.push_back(make_pair(x % 2 == 0 ? size - 2 : size - 1, x));
+        path.push_back(make_pair(x % 2 == 0 ? size - 1 : size - 2, x));
+    }
+    path.push_back(make_pair(size - 1, size - 1));
+
+    Board board{size, size};
+    for (size_t i = 0; i < path.size(); ++i) {
+        int ends = 0;
+        for (int k = -1; k <= 1; k += 2) {
+            pair<int, int> other;
+            if (i + k >= path.size()) {
+                // Before the first block is the inlet, after the last the outlet
+                ends |= k < 0 ? LEFT : RIGHT;
+                continue;
+            }
+            other = path[i + k];
+            for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+                if (path[i].first + deltaY(direction) == other.first && path[i].second + deltaX(direction) == other.second) {
+                    ends |= direction;
+                }
+            }
+        }
+        board.set_block(path[i].first, path[i].second, blockFor(ends));
+    }
+    return board;
+}
+
+static Board filled(int size, BlockType type) {
+    Board board{size, size};
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) board.set_block(y, x, type, 0);
+    }
+    return board;
+}
+
+static Board randomBoard(int size, int emptyPercent, uint64_t seed) {
+    Random random{seed};
+    Board board{size, size};
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (random.next_int(100) >= emptyPercent) {
+                board.set_block(y, x, static_cast<BlockType>(random.next_int(4)), random.next_int(4));
+            }
+        }
+    }
+    return board;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [options]\n"
+                    "  --filter TEXT   only benchmarks whose name contains TEXT\n"
+                    "  --samples N     timed samples per benchmark (20)\n"
+                    "  --time MS       length of one sample (10)\n"
+                    "  --warmup MS     minimum warmup per benchmark (100)\n"
+                    "  --levels PATH   level file (%s)\n"
+                    "  --json PATH     also write the results as JSON\n", name, PIPES_MAPS);
+}
+
+int main(int argc, char *argv[])
+{
+    Options options = {20, 0.010, 0.100, "", ""};
+    string levelsPath = PIPES_MAPS;
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *value = argv[++i];
+        if (option == "--filter") options.filter = value;
+        else if (option == "--samples") options.samples = max(1, atoi(value));
+        else if (option == "--time") options.sampleTime = atof(value) / 1000;
+        else if (option == "--warmup") options.warmupTime = atof(value) / 1000;
+        else if (option == "--levels") levelsPath = value;
+        else if (option == "--json") options.json = value;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    ifstream file(levelsPath.c_str(), ios::binary);
+    const string mapText((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    LevelTable levels;
+    ParseError error;
+    if (!levels.parse(mapText.data(), mapText.size(), &error)) {
+        fprintf(stderr, "%s:%d:%d: %s\n", levelsPath.c_str(), error.line, error.column, error.message.c_str());
+        return 1;
+    }
+
+    vector<Benchmark> benchmarks;
+    Board scratch = levels.get_count() > 0 ? levels.get_level(1) : Board();
+
+    benchmarks.push_back({"board/set_block_64", [&]() -> long long {
+        for (int i = 0; i < 64; ++i) scratch.set_block(i / 8, i % 8, static_cast<BlockType>(i & 3), i);
+        return scratch.get_cell(7, 7);
+    }});
+    benchmarks.push_back({"board/rotate_64", [&]() -> long long {
+        for (int i = 0; i < 64; ++i) scratch.rotate(i / 8, i % 8);
+        return scratch.get_cell(7, 7);
+    }});
+
+    vector<Board> shipped;
+    for (int level = 1; level <= levels.get_count(); ++level) shipped.push_back(levels.get_level(level));
+    for (size_t i = 0; i < shipped.size(); ++i) {
+        const Board &board = shipped[i];
+        char name[64];
+        snprintf(name, sizeof(name), "evaluate/level_%d", static_cast<int>(i + 1));
+        benchmarks.push_back({name, [&board]() -> long long { return evaluate(board).cycles; }});
+        snprintf(name, sizeof(name), "evaluate_layers/level_%d", static_cast<int>(i + 1));
+        benchmarks.push_back({name, [&board]() -> long long {
+            vector<int> layers;
+            return evaluate(board, &layers).cycles;
+        }});
+        snprintf(name, sizeof(name), "solve/level_%d", static_cast<int>(i + 1));
+        benchmarks.push_back({name, [&board]() -> long long { return Solver(board).solve().steps; }});
+    }
+
+    const Board cross8 = filled(8, BlockType::CROSS);
+    const Board serpentine8 = serpentine(8);
+    // The sizes with kernels of their own, see evaluator.cpp and swipe.cpp
+    const Board serpentine16 = serpentine(16);
+    const Board serpentine32 = serpentine(32);
+    benchmarks.push_back({"evaluate/serpentine_16", [&]() -> long long { return evaluate(serpentine16).cycles; }});
+    benchmarks.push_back({"evaluate/serpentine_32", [&]() -> long long { return evaluate(serpentine32).cycles; }});
+    const Board cross256 = filled(256, BlockType::CROSS);
+    const Board serpentine256 = serpentine(256);
+    benchmarks.push_back({"evaluate/all_cross_8", [&]() -> long long { return evaluate(cross8).cycles; }});
+    benchmarks.push_back({"evaluate/serpentine_8", [&]() -> long long { return evaluate(serpentine8).cycles; }});
+    benchmarks.push_back({"evaluate_layers/serpentine_8", [&]() -> long long {
+        vector<int> layers;
+        return evaluate(serpentine8, &layers).cycles;
+    }});
+    benchmarks.push_back({"evaluate/all_cross_256", [&]() -> long long { return evaluate(cross256).status; }});
+    benchmarks.push_back({"evaluate/serpentine_256", [&]() -> long long { return evaluate(serpentine256).status; }});
+    benchmarks.push_back({"evaluate_layers/serpentine_256", [&]() -> long long {
+        vector<int> layers;
+        return evaluate(serpentine256, &layers).cycles;
+    }});
+
+    LiveFlow flow{scratch};
+    benchmarks.push_back({"liveflow/rotate_changed", [&]() -> long long {
+        scratch.rotate(3, 4);
+        flow.changed(3, 4);
+        return flow.get_status();
+    }});
+
+    const Board dense = randomBoard(8, 25, 7);
+    static const char *directions[] = {"left", "up", "right", "down"};
+    for (int direction = SWIPE_LEFT; direction <= SWIPE_DOWN; ++direction) {
+        benchmarks.push_back({string("swipe/") + directions[direction], [&, direction]() -> long long {
+            scratch = dense;
+            swipe(scratch, static_cast<SwipeDirection>(direction));
+            return scratch.get_cell(0, 0);
+        }});
+    }
+    const Board dense32 = randomBoard(32, 25, 7);
+    benchmarks.push_back({"swipe/left_32", [&]() -> long long {
+        Board board = dense32;
+        swipe(board, SWIPE_LEFT);
+        return board.get_cell(0, 0);
+    }});
+    benchmarks.push_back({"swipe/combine", []() -> long long {
+        long long merged = 0;
+        for (int type = 0; type < BlockType::EMPTY; ++type) {
+            BlockData destination = {static_cast<BlockType>(type), 1};
+            BlockData part = {static_cast<BlockType>(type), 2};
+            combine(destination, part);
+            merged += destination.type + part.type;
+        }
+        return merged;
+    }});
+
+    const Board halfFull = randomBoard(8, 50, 11);
+    Random spawns{3};
+    benchmarks.push_back({"spawn/add_random_pipe", [&]() -> long long {
+        scratch = halfFull;
+        return addRandomPipe(scratch, spawns);
+    }});
+
+    uint64_t packed[5];
+    benchmarks.push_back({"history/pack_unpack", [&]() -> long long {
+        packBoard(halfFull, packed);
+        unpackBoard(packed, scratch);
+        return static_cast<long long>(scratch.get_hash() & 0xff);
+    }});
+    History rotations;
+    benchmarks.push_back({"history/undo_redo_rotation", [&]() -> long long {
+        if (!rotations.can_undo()) {
+            scratch.rotate(2, 5);
+            rotations.add_rotation(2, 5);
+        }
+        rotations.undo(scratch);
+        rotations.redo(scratch);
+        return scratch.get_cell(2, 5);
+    }});
+    History swipes;
+    benchmarks.push_back({"history/undo_redo_swipe", [&]() -> long long {
+        if (!swipes.can_undo()) {
+            scratch = dense;
+            swipes.add_snapshot(scratch);
+            swipe(scratch, SWIPE_LEFT);
+        }
+        swipes.undo(scratch);
+        swipes.redo(scratch);
+        return scratch.get_cell(0, 0);
+    }});
+
+    // 256 boards of one size in lockstep, against evaluate() one at a time.
+    // Random boards mostly leak within a few blocks; the serpentines are
+    // solved and the water has to visit every block.
+    for (int size = 8; size <= 16; size += 8) {
+        for (int solved = 0; solved < 2; ++solved) {
+            vector<Board> candidates;
+            for (int i = 0; i < BoardBatch::LANES; ++i) {
+                candidates.push_back(solved ? serpentine(size) : randomBoard(size, 10, 100 + i));
+            }
+            for (size_t i = 0; i < shipped.size() && size == 8 && !solved; ++i) candidates[i] = shipped[i];
+            const char *kind = solved ? "_serpentine" : "";
+            char name[64];
+            snprintf(name, sizeof(name), "batch/evaluate_%d%s_%s", size, kind, BoardBatch::get_instructions());
+            benchmarks.push_back({name, [candidates, size]() -> long long {
+                BoardBatch batch{size, size};
+                for (size_t i = 0; i < candidates.size(); ++i) batch.add(candidates[i]);
+                BFSStatus statuses[BoardBatch::LANES];
+                batch.evaluate(statuses);
+                return statuses[0] + statuses[BoardBatch::LANES - 1];
+            }, BoardBatch::LANES});
+            snprintf(name, sizeof(name), "batch/evaluate_%d%s_one_by_one", size, kind);
+            benchmarks.push_back({name, [candidates]() -> long long {
+                long long connected = 0;
+                for (size_t i = 0; i < candidates.size(); ++i) connected += evaluate(candidates[i]).status;
+                return connected;
+            }, BoardBatch::LANES});
+        }
+    }
+
+    benchmarks.push_back({"levels/parse_maps", [&]() -> long long {
+        LevelTable table;
+        table.parse(mapText.data(), mapText.size());
+        return table.get_count();
+    }});
+    benchmarks.push_back({"levels/load_level", [&]() -> long long {
+        levels.load_level(1, scratch);
+        return scratch.get_cell(0, 0);
+    }});
+
+    vector<Result> results;
+    printf("%-40s %12s %12s %12s %10s %14s\n", "benchmark", "median ns", "min ns", "mean ns", "stddev %", "boards/s");
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+        if (!options.filter.empty() && benchmarks[i].name.find(options.filter) == string::npos) continue;
+        Result result = measure(benchmarks[i], options);
+        printf("%-40s %12.1f %12.1f %12.1f %10.1f", result.name.c_str(), result.median, result.min,
+               result.mean, result.mean > 0 ? 100 * result.stddev / result.mean : 0.0);
+        if (result.items > 0) printf(" %14.0f", result.items * 1e9 / result.median);
+        printf("\n");
+        fflush(stdout);
+        results.push_back(result);
+    }
+
+    if (!options.json.empty() && !writeJson(options.json, results, options)) {
+        fprintf(stderr, "%s: can not write the results\n", options.json.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Repeated cold starts of the game: time to the first frame as measured by the
+# game itself, and the wall time of the whole run including process start-up,
+# loading and exit. Set QT_QPA_PLATFORM=offscreen where there is no display.
+#
+#   bench/startup.sh path/to/Pipes [runs]
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 <Pipes executable> [runs]" >&2
+    exit 2
+fi
+game=$1
+runs=${2:-10}
+
+results=$(mktemp)
+trap 'rm -f "$results"' EXIT
+
+i=0
+while [ "$i" -lt "$runs" ]; do
+    start=$(date +%s%N)
+    frame=$("$game" --startup-benchmark 2>&1 | awk '/^startup first frame/ { print $4 }')
+    end=$(date +%s%N)
+    if [ -z "$frame" ]; then
+        echo "$game did not report its first frame" >&2
+        exit 1
+    fi
+    echo "$frame $(( (end - start) / 1000 ))" >> "$results"
+    i=$((i + 1))
+done
+
+# Median, min and max of one column, in milliseconds
+summary() {
+    cut -d ' ' -f "$2" "$results" | sort -n | awk -v name="$1" -v scale="$3" '
+        { value[NR] = $1 / scale }
+        END { printf "%-12s median %8.2f ms  min %8.2f ms  max %8.2f ms\n", name, value[int((NR + 1) / 2)], value[1], value[NR] }'
+}
+
+echo "$runs runs"
+summary "first frame" 1 1
+summary "whole run" 2 1000
@@ -0,0 +1,36 @@
+#include <QPixmap>
+
+#include "blockimages.h"
+#include "trace.h"
+
+QPixmap BlockImages::images[BlockImages::TYPES][BlockImages::ORIENTATIONS][2];
+QSize BlockImages::scaledSize;
+
+QString BlockImages::get_path(BlockType type, int orientation, bool highlighted)
+{
+    return QString(":/resources/images/blocks_jpg/block%1_%2%3.jpg")
+        .arg(static_cast<int>(type)).arg(orientation).arg(highlighted ? "_f" : "");
+}
+
+const QPixmap &BlockImages::get(BlockType type, int orientation, bool highlighted, const QSize &size)
+{
+    // Empty blocks never carry water and have no highlighted image
+    if (type == BlockType::EMPTY) highlighted = false;
+
+    if (size != scaledSize) {
+        for (int t = 0; t < TYPES; ++t) {
+            for (int o = 0; o < ORIENTATIONS; ++o) {
+                images[t][o][0] = images[t][o][1] = QPixmap();
+            }
+        }
+        scaledSize = size;
+    }
+
+    QPixmap &image = images[type][orientation][highlighted ? 1 : 0];
+    if (image.isNull()) {
+        PIPES_TRACE_SCOPE("BlockImages::decode");
+        image = QPixmap(get_path(type, orientation, highlighted))
+            .scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
@@ -0,0 +1,25 @@
+#ifndef BLOCKIMAGES_H
+#define BLOCKIMAGES_H
+
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+#include "pipe.h"
+
+// Block images shared by the whole process. Each image is decoded and scaled
+// to the block size once, so drawing a block is a plain blit.
+class BlockImages
+{
+ public:
+    static const QPixmap &get(BlockType type, int orientation, bool highlighted, const QSize &size);
+    static QString get_path(BlockType type, int orientation, bool highlighted);
+
+ private:
+    static const int TYPES = BlockType::EMPTY + 1;
+    static const int ORIENTATIONS = 4;
+    static QPixmap images[TYPES][ORIENTATIONS][2];
+    static QSize scaledSize;
+};
+
+#endif // BLOCKIMAGES_H
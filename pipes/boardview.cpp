@@ -0,0 +1,113 @@
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <algorithm>
+
+#include "boardview.h"
+#include "blockimages.h"
+#include "trace.h"
+
+using namespace std;
+
+BoardView::BoardView(QWidget *parent):
+    QWidget(parent),
+    height(0),
+    width(0),
+    blockSize(0),
+    hintY(-1),
+    hintX(-1)
+{
+    // Every cell is covered by its image
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setGeometry(QRect(NORMAL_X, NORMAL_Y, BOARD_PIXELS, BOARD_PIXELS));
+}
+
+void BoardView::set_board_size(int height, int width)
+{
+    this->height = height;
+    this->width = width;
+    this->blockSize = max(1, BOARD_PIXELS / max(1, max(height, width)));
+    Cell empty = {BlockType::EMPTY, 0, false};
+    this->cells.assign(static_cast<size_t>(height) * width, empty);
+    this->hintY = this->hintX = -1;
+    this->resize(this->blockSize * width, this->blockSize * height);
+    this->update();
+}
+
+void BoardView::set_block(int y, int x, BlockType type, int orientation)
+{
+    Cell &cell = this->cells[static_cast<size_t>(y) * this->width + x];
+    if (cell.type == type && cell.orientation == orientation) return;
+    cell.type = type;
+    cell.orientation = orientation;
+    this->updateCell(y, x);
+}
+
+void BoardView::set_highlighted(int y, int x, bool value)
+{
+    Cell &cell = this->cells[static_cast<size_t>(y) * this->width + x];
+    if (cell.highlighted == value) return;
+    cell.highlighted = value;
+    this->updateCell(y, x);
+}
+
+bool BoardView::get_highlighted(int y, int x) const
+{
+    return this->cells[static_cast<size_t>(y) * this->width + x].highlighted;
+}
+
+void BoardView::set_hint(int y, int x)
+{
+    if (y == this->hintY && x == this->hintX) return;
+    if (this->hintY >= 0) this->updateCell(this->hintY, this->hintX);
+    this->hintY = y;
+    this->hintX = x;
+    if (y >= 0) this->updateCell(y, x);
+}
+
+int BoardView::get_block_size() const
+{
+    return this->blockSize;
+}
+
+void BoardView::updateCell(int y, int x)
+{
+    this->update(x * this->blockSize, y * this->blockSize, this->blockSize, this->blockSize);
+}
+
+void BoardView::paintEvent(QPaintEvent *event)
+{
+    PIPES_TRACE_SCOPE("BoardView::paintEvent");
+    if (this->cells.empty()) return;
+    QPainter painter(this);
+    QSize size(this->blockSize, this->blockSize);
+
+    // Only visit the cells inside the dirty area
+    QRect dirty = event->rect();
+    int top = max(0, dirty.top() / this->blockSize);
+    int left = max(0, dirty.left() / this->blockSize);
+    int bottom = min(this->height - 1, dirty.bottom() / this->blockSize);
+    int right = min(this->width - 1, dirty.right() / this->blockSize);
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            const Cell &cell = this->cells[static_cast<size_t>(y) * this->width + x];
+            painter.drawPixmap(x * this->blockSize, y * this->blockSize,
+                               BlockImages::get(cell.type, cell.orientation, cell.highlighted, size));
+        }
+    }
+    if (this->hintY >= top && this->hintY <= bottom && this->hintX >= left && this->hintX <= right) {
+        painter.setPen(QPen(QColor(255, 200, 0), 3));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(this->hintX * this->blockSize + 1, this->hintY * this->blockSize + 1,
+                         this->blockSize - 3, this->blockSize - 3);
+    }
+}
+
+void BoardView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || this->blockSize == 0) return;
+    int y = event->pos().y() / this->blockSize;
+    int x = event->pos().x() / this->blockSize;
+    if (y < 0 || y >= this->height || x < 0 || x >= this->width) return;
+    emit blockPressed(y, x);
+}
@@ -0,0 +1,53 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include <QWidget>
+#include <vector>
+
+#include "pipe.h"
+
+// Draws the whole grid in one widget. Changed cells are scheduled for repaint
+// on their own, and a click is mapped to its cell arithmetically.
+class BoardView : public QWidget
+{
+    Q_OBJECT
+
+ public:
+    static const int NORMAL_X = 117;
+    static const int NORMAL_Y = 146;
+    static const int BOARD_PIXELS = 464;
+
+    explicit BoardView(QWidget *parent = nullptr);
+    void set_board_size(int height, int width);
+    void set_block(int y, int x, BlockType type, int orientation);
+    void set_highlighted(int y, int x, bool value);
+    bool get_highlighted(int y, int x) const;
+    // Outlines one block, -1 clears the outline
+    void set_hint(int y, int x);
+    int get_block_size() const;
+
+ private:
+    struct Cell
+    {
+        BlockType type;
+        int orientation;
+        bool highlighted;
+    };
+
+    int height;
+    int width;
+    int blockSize;
+    int hintY;
+    int hintX;
+    std::vector<Cell> cells;
+    void updateCell(int y, int x);
+
+ protected:
+    void paintEvent(QPaintEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+
+ signals:
+    void blockPressed(int y, int x);
+};
+
+#endif // BOARDVIEW_H
@@ -0,0 +1,360 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "batchevaluator.h"
+#include "bitboard.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace {
+
+// One bit per lane, BoardBatch::WORDS words
+#if defined(__AVX2__)
+
+struct Lanes {
+    __m256i bits;
+};
+
+inline Lanes load(const uint64_t *words) {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(words))};
+}
+
+inline void store(uint64_t *words, Lanes lanes) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(words), lanes.bits);
+}
+
+inline Lanes none() {
+    return {_mm256_setzero_si256()};
+}
+
+inline Lanes all() {
+    return {_mm256_set1_epi64x(-1)};
+}
+
+inline Lanes operator&(Lanes a, Lanes b) {
+    return {_mm256_and_si256(a.bits, b.bits)};
+}
+
+inline Lanes operator|(Lanes a, Lanes b) {
+    return {_mm256_or_si256(a.bits, b.bits)};
+}
+
+// a & ~b
+inline Lanes andNot(Lanes a, Lanes b) {
+    return {_mm256_andnot_si256(b.bits, a.bits)};
+}
+
+inline bool any(Lanes a) {
+    return !_mm256_testz_si256(a.bits, a.bits);
+}
+
+const char *INSTRUCTIONS = "avx2";
+
+#elif defined(__SSE2__)
+
+struct Lanes {
+    __m128i low;
+    __m128i high;
+};
+
+inline Lanes load(const uint64_t *words) {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(words)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + 2))};
+}
+
+inline void store(uint64_t *words, Lanes lanes) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(words), lanes.low);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(words + 2), lanes.high);
+}
+
+inline Lanes none() {
+    return {_mm_setzero_si128(), _mm_setzero_si128()};
+}
+
+inline Lanes all() {
+    return {_mm_set1_epi32(-1), _mm_set1_epi32(-1)};
+}
+
+inline Lanes operator&(Lanes a, Lanes b) {
+    return {_mm_and_si128(a.low, b.low), _mm_and_si128(a.high, b.high)};
+}
+
+inline Lanes operator|(Lanes a, Lanes b) {
+    return {_mm_or_si128(a.low, b.low), _mm_or_si128(a.high, b.high)};
+}
+
+inline Lanes andNot(Lanes a, Lanes b) {
+    return {_mm_andnot_si128(b.low, a.low), _mm_andnot_si128(b.high, a.high)};
+}
+
+inline bool any(Lanes a) {
+    __m128i bits = _mm_or_si128(a.low, a.high);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())) != 0xFFFF;
+}
+
+const char *INSTRUCTIONS = "sse2";
+
+#else
+
+struct Lanes {
+    uint64_t words[BoardBatch::WORDS];
+};
+
+inline Lanes load(const uint64_t *words) {
+    Lanes lanes;
+    for (int i = 0; i < BoardBatch::WORDS; ++i) lanes.words[i] = words[i];
+    return lanes;
+}
+
+inline void store(uint64_t *words, Lanes lanes) {
+    for (int i = 0; i < BoardBatch::WORDS; ++i) words[i] = lanes.words[i];
+}
+
+inline Lanes none() {
+    Lanes lanes;
+    for (int i = 0; i < BoardBatch::WORDS; ++i) lanes.words[i] = 0;
+    return lanes;
+}
+
+inline Lanes all() {
+    Lanes lanes;
+    for (int i = 0; i < BoardBatch::WORDS; ++i) lanes.words[i] = ~0ULL;
+    return lanes;
+}
+
+inline Lanes operator&(Lanes a, Lanes b) {
+    for (int i = 0; i < BoardBatch::WORDS; ++i) a.words[i] &= b.words[i];
+    return a;
+}
+
+inline Lanes operator|(Lanes a, Lanes b) {
+    for (int i = 0; i < BoardBatch::WORDS; ++i) a.words[i] |= b.words[i];
+    return a;
+}
+
+inline Lanes andNot(Lanes a, Lanes b) {
+    for (int i = 0; i < BoardBatch::WORDS; ++i) a.words[i] &= ~b.words[i];
+    return a;
+}
+
+inline bool any(Lanes a) {
+    uint64_t bits = 0;
+    for (int i = 0; i < BoardBatch::WORDS; ++i) bits |= a.words[i];
+    return bits != 0;
+}
+
+const char *INSTRUCTIONS = "scalar";
+
+#endif
+
+// Ends in the order of BoardBatch::ends
+const int END_LEFT = 0;
+const int END_UP = 1;
+const int END_RIGHT = 2;
+const int END_DOWN = 3;
+
+// Swap matrix[i] bit j with matrix[j] bit i: the off-diagonal halves of the
+// 64x64 bit matrix trade places, then those of each quarter, down to bits
+void transpose(uint64_t *matrix) {
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (int width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+        for (int i = 0; i < 64; i = ((i | width) + 1) & ~width) {
+            uint64_t swapped = ((matrix[i] >> width) ^ matrix[i | width]) & mask;
+            matrix[i | width] ^= swapped;
+            matrix[i] ^= swapped << width;
+        }
+    }
+}
+
+}
+
+BoardBatch::BoardBatch(int _height, int _width):
+    height(_height),
+    width(_width),
+    count(0),
+    chunks((_height * _width + 63) / 64),
+    planes(static_cast<size_t>(LANES) * 4 * chunks, 0)
+{
+}
+
+int BoardBatch::get_height() const {
+    return this->height;
+}
+
+int BoardBatch::get_width() const {
+    return this->width;
+}
+
+int BoardBatch::get_count() const {
+    return this->count;
+}
+
+void BoardBatch::clear() {
+    this->planes.assign(this->planes.size(), 0);
+    this->count = 0;
+}
+
+int BoardBatch::add(const Board &board) {
+    if (this->count == LANES || board.get_height() != this->height || board.get_width() != this->width) return -1;
+    // Bit planes of this board alone, 8 blocks per multiplication as in
+    // BitBoard; evaluate() transposes 64 boards at a time into lanes
+    const int lane = this->count++;
+    const int blocks = this->height * this->width;
+    const unsigned char *cells = board.get_cells();
+    uint64_t *planes = this->planes.data() + static_cast<size_t>(lane) * 4 * this->chunks;
+    for (int block = 0; block < blocks; block += 8) {
+        uint64_t ends = 0;
+        const int group = min(8, blocks - block);
+        for (int i = 0; i < group; ++i) {
+            ends |= static_cast<uint64_t>(Board::cell_direction(cells[block + i])) << (8 * i);
+        }
+        uint64_t *plane = planes + block / 64;
+        const int shift = block % 64;
+        plane[END_LEFT * this->chunks] |= gatherRow(ends) << shift;
+        plane[END_UP * this->chunks] |= gatherRow(ends >> 1) << shift;
+        plane[END_RIGHT * this->chunks] |= gatherRow(ends >> 2) << shift;
+        plane[END_DOWN * this->chunks] |= gatherRow(ends >> 3) << shift;
+    }
+    return lane;
+}
+
+void BoardBatch::evaluate(BFSStatus *statuses) const {
+    PIPES_TRACE_SCOPE("BoardBatch::evaluate");
+    if (this->count == 0) return;
+    const int height = this->height;
+    const int width = this->width;
+    const int blocks = height * width;
+    if (blocks == 0) {
+        // Nowhere for the water to go
+        for (int lane = 0; lane < this->count; ++lane) statuses[lane] = BFSStatus::LEAKAGE;
+        return;
+    }
+
+    // (block * 4 + end) * WORDS + lane / 64, a bit per lane. Lanes past count
+    // have no pipe ends, so they leak at the inlet.
+    vector<uint64_t> endBits(static_cast<size_t>(blocks) * 4 * WORDS, 0);
+    uint64_t matrix[64];
+    for (int word = 0; word < (this->count + 63) / 64; ++word) {
+        for (int end = 0; end < 4; ++end) {
+            for (int chunk = 0; chunk < this->chunks; ++chunk) {
+                for (int i = 0; i < 64; ++i) {
+                    matrix[i] = this->planes[(static_cast<size_t>(word * 64 + i) * 4 + end) * this->chunks + chunk];
+                }
+                transpose(matrix);
+                for (int i = 0; i < 64 && chunk * 64 + i < blocks; ++i) {
+                    endBits[((chunk * 64 + i) * 4 + end) * WORDS + word] = matrix[i];
+                }
+            }
+        }
+    }
+    const uint64_t *ends = endBits.data();
+
+    // Pipe ends meeting a matching end on the block to the right or below
+    vector<uint64_t> toRight(static_cast<size_t>(blocks) * WORDS);
+    vector<uint64_t> toDown(static_cast<size_t>(blocks) * WORDS);
+    for (int block = 0; block < blocks; ++block) {
+        const uint64_t *end = ends + block * 4 * WORDS;
+        int x = block % width;
+        store(&toRight[block * WORDS], x + 1 < width
+              ? load(end + END_RIGHT * WORDS) & load(end + (4 + END_LEFT) * WORDS) : none());
+        store(&toDown[block * WORDS], block + width < blocks
+              ? load(end + END_DOWN * WORDS) & load(end + (4 * width + END_UP) * WORDS) : none());
+    }
+
+    // A wet block leaks through every end without a matching end, except
+    // towards the inlet and the outlet
+    vector<uint64_t> unmatched(static_cast<size_t>(blocks) * WORDS);
+    for (int block = 0; block < blocks; ++block) {
+        const uint64_t *end = ends + block * 4 * WORDS;
+        int x = block % width;
+        Lanes open = none();
+        if (x > 0) {
+            open = andNot(load(end + END_LEFT * WORDS), load(&toRight[(block - 1) * WORDS]));
+        } else if (block != 0) {
+            open = load(end + END_LEFT * WORDS);
+        }
+        if (x + 1 < width) {
+            open = open | andNot(load(end + END_RIGHT * WORDS), load(&toRight[block * WORDS]));
+        } else if (block != blocks - 1) {
+            open = open | load(end + END_RIGHT * WORDS);
+        }
+        if (block >= width) {
+            open = open | andNot(load(end + END_UP * WORDS), load(&toDown[(block - width) * WORDS]));
+        } else {
+            open = open | load(end + END_UP * WORDS);
+        }
+        if (block + width < blocks) {
+            open = open | andNot(load(end + END_DOWN * WORDS), load(&toDown[block * WORDS]));
+        } else {
+            open = open | load(end + END_DOWN * WORDS);
+        }
+        store(&unmatched[block * WORDS], open);
+    }
+
+    // Forward sweeps carry the water right and down, backward sweeps left and
+    // up; they alternate until no board that has not leaked yet gets another
+    // wet block. No water at all leaks at the inlet.
+    vector<uint64_t> wet(static_cast<size_t>(blocks) * WORDS, 0);
+    store(&wet[0], load(ends + END_LEFT * WORDS));
+    Lanes leak = andNot(all(), load(ends + END_LEFT * WORDS));
+    bool grown = true;
+    while (grown) {
+        Lanes fresh = none();
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int i = 0; i < blocks; ++i) {
+                int block = pass == 0 ? i : blocks - 1 - i;
+                int x = block % width;
+                Lanes before = load(&wet[block * WORDS]);
+                Lanes after = before;
+                if (x > 0) after = after | (load(&wet[(block - 1) * WORDS]) & load(&toRight[(block - 1) * WORDS]));
+                if (x + 1 < width) after = after | (load(&wet[(block + 1) * WORDS]) & load(&toRight[block * WORDS]));
+                if (block >= width) after = after | (load(&wet[(block - width) * WORDS]) & load(&toDown[(block - width) * WORDS]));
+                if (block + width < blocks) after = after | (load(&wet[(block + width) * WORDS]) & load(&toDown[block * WORDS]));
+                fresh = fresh | andNot(after, before);
+                leak = leak | (after & load(&unmatched[block * WORDS]));
+                store(&wet[block * WORDS], after);
+            }
+        }
+        grown = any(andNot(fresh, leak));
+    }
+    Lanes connected = andNot(load(&wet[(blocks - 1) * WORDS]) & load(ends + ((blocks - 1) * 4 + END_RIGHT) * WORDS),
+                             leak);
+
+    uint64_t leakWords[WORDS];
+    uint64_t connectedWords[WORDS];
+    store(leakWords, leak);
+    store(connectedWords, connected);
+    for (int lane = 0; lane < this->count; ++lane) {
+        uint64_t bit = 1ULL << (lane % 64);
+        if (leakWords[lane / 64] & bit) {
+            statuses[lane] = BFSStatus::LEAKAGE;
+        } else if (connectedWords[lane / 64] & bit) {
+            statuses[lane] = BFSStatus::CONNECTED;
+        } else {
+            statuses[lane] = BFSStatus::STUCK;
+        }
+    }
+}
+
+const char *BoardBatch::get_instructions() {
+    return INSTRUCTIONS;
+}
+
+vector<BFSStatus> evaluateBatch(const vector<Board> &boards) {
+    vector<BFSStatus> statuses(boards.size());
+    size_t first = 0;
+    while (first < boards.size()) {
+        BoardBatch batch(boards[first].get_height(), boards[first].get_width());
+        size_t next = first;
+        while (next < boards.size() && batch.add(boards[next]) >= 0) ++next;
+        batch.evaluate(&statuses[first]);
+        first = next;
+    }
+    return statuses;
+}
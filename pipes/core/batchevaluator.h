@@ -0,0 +1,55 @@
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "evaluator.h"
+
+// Up to LANES boards of one size in structure-of-arrays layout: for every
+// block and pipe end one bit per board, so a single vector register holds
+// the same pipe end of every board and the water of all of them advances
+// together. Built with AVX2 (qmake CONFIG+=avx2) a mask is one register,
+// otherwise two SSE2 registers or plain words.
+//
+// Every block of every board is visited until the slowest board settles, so
+// this only beats evaluate() when most boards carry the water far, such as
+// solved or nearly solved ones. Boards that leak within a few blocks, as most
+// random ones do, are evaluated faster one at a time.
+class BoardBatch
+{
+ public:
+    static const int LANES = 256;
+    static const int WORDS = LANES / 64;
+
+    BoardBatch(int _height, int _width);
+
+    int get_height() const;
+    int get_width() const;
+    int get_count() const;
+    void clear();
+    // The lane of the board, or -1 if the batch is full or the size differs
+    int add(const Board &board);
+
+    // statuses[lane] for every lane below get_count(); same outcome as
+    // evaluate() on each board, without the cycles
+    void evaluate(BFSStatus *statuses) const;
+
+    // The name of the vector instructions in use
+    static const char *get_instructions();
+
+ private:
+    int height;
+    int width;
+    int count;
+    int chunks;
+    // (lane * 4 + end) * chunks + block / 64, the blocks of each board with a
+    // pipe end towards LEFT, UP, RIGHT and DOWN as in BitBoard
+    std::vector<uint64_t> planes;
+};
+
+// evaluate() for any number of boards, LANES at a time for boards of one size
+std::vector<BFSStatus> evaluateBatch(const std::vector<Board> &boards);
+
+#endif // BATCHEVALUATOR_H
@@ -0,0 +1,74 @@
+#include <algorithm>
+
+#include "bigcount.h"
+
+using namespace std;
+
+BigCount::BigCount(uint64_t value)
+{
+    for (; value != 0; value >>= 32) {
+        this->limbs.push_back(static_cast<uint32_t>(value));
+    }
+}
+
+bool BigCount::is_zero() const {
+    return this->limbs.empty();
+}
+
+BigCount &BigCount::operator+=(const BigCount &other) {
+    if (other.limbs.size() > this->limbs.size()) this->limbs.resize(other.limbs.size(), 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < this->limbs.size() && (carry != 0 || i < other.limbs.size()); ++i) {
+        carry += this->limbs[i];
+        if (i < other.limbs.size()) carry += other.limbs[i];
+        this->limbs[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    if (carry != 0) this->limbs.push_back(static_cast<uint32_t>(carry));
+    return *this;
+}
+
+BigCount &BigCount::operator*=(uint32_t factor) {
+    if (factor == 0) {
+        this->limbs.clear();
+        return *this;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < this->limbs.size(); ++i) {
+        carry += static_cast<uint64_t>(this->limbs[i]) * factor;
+        this->limbs[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    if (carry != 0) this->limbs.push_back(static_cast<uint32_t>(carry));
+    return *this;
+}
+
+bool BigCount::operator==(const BigCount &other) const {
+    return this->limbs == other.limbs;
+}
+
+bool BigCount::operator!=(const BigCount &other) const {
+    return this->limbs != other.limbs;
+}
+
+string BigCount::to_string() const {
+    if (this->limbs.empty()) return "0";
+    // Peel off nine decimal digits at a time
+    vector<uint32_t> value = this->limbs;
+    string digits;
+    while (!value.empty()) {
+        uint64_t remainder = 0;
+        for (size_t i = value.size(); i-- > 0;) {
+            uint64_t current = (remainder << 32) | value[i];
+            value[i] = static_cast<uint32_t>(current / 1000000000);
+            remainder = current % 1000000000;
+        }
+        while (!value.empty() && value.back() == 0) value.pop_back();
+        for (int i = 0; i < 9 && (!value.empty() || remainder != 0); ++i) {
+            digits.push_back(static_cast<char>('0' + remainder % 10));
+            remainder /= 10;
+        }
+    }
+    reverse(digits.begin(), digits.end());
+    return digits;
+}
@@ -0,0 +1,27 @@
+#ifndef BIGCOUNT_H
+#define BIGCOUNT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Unsigned integer of any size, just enough arithmetic for counting
+class BigCount
+{
+ public:
+    BigCount(uint64_t value = 0);
+
+    bool is_zero() const;
+    BigCount &operator+=(const BigCount &other);
+    BigCount &operator*=(uint32_t factor);
+    bool operator==(const BigCount &other) const;
+    bool operator!=(const BigCount &other) const;
+    // Decimal
+    std::string to_string() const;
+
+ private:
+    // Little-endian base 2^32, no leading zero limbs
+    std::vector<uint32_t> limbs;
+};
+
+#endif // BIGCOUNT_H
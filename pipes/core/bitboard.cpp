@@ -0,0 +1,73 @@
+#include "bitboard.h"
+
+static const uint64_t FIRST_COLUMN = 0x0101010101010101ULL;
+static const uint64_t LAST_COLUMN = FIRST_COLUMN << (BitBoard::SIZE - 1);
+static const uint64_t INLET = 1ULL;
+static const uint64_t OUTLET = 1ULL << (BitBoard::SIZE * BitBoard::SIZE - 1);
+
+BitBoard::BitBoard():
+    left(0),
+    up(0),
+    right(0),
+    down(0)
+{
+}
+
+BitBoard::BitBoard(const Board &board):
+    BitBoard()
+{
+    // The ends of a row, one byte per block, are gathered into each plane by a
+    // multiplication instead of testing every block
+    const unsigned char *cells = board.get_cells();
+    for (int y = 0; y < SIZE; ++y) {
+        uint64_t ends = 0;
+        for (int x = 0; x < SIZE; ++x) {
+            ends |= static_cast<uint64_t>(Board::cell_direction(cells[y * SIZE + x])) << (8 * x);
+        }
+        this->left |= gatherRow(ends) << (y * SIZE);
+        this->up |= gatherRow(ends >> 1) << (y * SIZE);
+        this->right |= gatherRow(ends >> 2) << (y * SIZE);
+        this->down |= gatherRow(ends >> 3) << (y * SIZE);
+    }
+}
+
+BFSResult evaluateBits(const BitBoard &bits, uint64_t *layers) {
+    // Cannot flow from the inlet
+    if ((bits.left & INLET) == 0) {
+        return {BFSStatus::LEAKAGE, 1};
+    }
+
+    // Pipe ends meeting a matching end on the neighbouring block
+    const uint64_t toLeft = bits.left & ~FIRST_COLUMN & (bits.right << 1);
+    const uint64_t toRight = bits.right & ~LAST_COLUMN & (bits.left >> 1);
+    const uint64_t toUp = bits.up & (bits.down << BitBoard::SIZE);
+    const uint64_t toDown = bits.down & (bits.up >> BitBoard::SIZE);
+
+    uint64_t wet = INLET;
+    uint64_t front = INLET;
+    int count = 0;
+    while (front) {
+        if (layers != nullptr) {
+            layers[count] = front;
+        }
+        ++count;
+        front = ((front & toLeft) >> 1)
+              | ((front & toRight) << 1)
+              | ((front & toUp) >> BitBoard::SIZE)
+              | ((front & toDown) << BitBoard::SIZE);
+        front &= ~wet;
+        wet |= front;
+    }
+
+    const uint64_t leak = (wet & bits.left & ~toLeft & ~INLET)
+                        | (wet & bits.right & ~toRight & ~OUTLET)
+                        | (wet & bits.up & ~toUp)
+                        | (wet & bits.down & ~toDown);
+    BFSStatus status = BFSStatus::STUCK;
+    if (leak) {
+        status = BFSStatus::LEAKAGE;
+    } else if (wet & bits.right & OUTLET) {
+        status = BFSStatus::CONNECTED;
+    }
+    return {status, count + 1};
+}
@@ -0,0 +1,48 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+#include "board.h"
+#include "evaluator.h"
+
+// An 8x8 board as four direction planes, bit y * 8 + x set when the block
+// at (y, x) has a pipe end towards that direction
+struct BitBoard {
+    static const int SIZE = 8;
+    static const int MAX_LAYERS = SIZE * SIZE;
+
+    uint64_t left;
+    uint64_t up;
+    uint64_t right;
+    uint64_t down;
+
+    BitBoard();
+    explicit BitBoard(const Board &board);
+};
+
+// Index of the lowest set bit
+inline int lowestBit(uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int index = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Bit 8 * x of `bytes` becomes bit x; the partial products never overlap
+inline uint64_t gatherRow(uint64_t bytes) {
+    return ((bytes & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+}
+
+// Same outcome as evaluate() without any allocation. layers[i] receives the
+// blocks the water first reaches at step i; `cycles` is the number of layers
+// plus one.
+BFSResult evaluateBits(const BitBoard &bits, uint64_t *layers = nullptr);
+
+#endif // BITBOARD_H
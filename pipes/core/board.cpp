@@ -0,0 +1,58 @@
+#include <cstddef>
+
+#include "board.h"
+
+uint64_t Board::zobristKeys[Board::ZOBRIST_BLOCKS * 32];
+
+const bool Board::zobristFilled = Board::fill_zobrist_keys();
+
+bool Board::fill_zobrist_keys() {
+    for (int i = 0; i < ZOBRIST_BLOCKS * 32; ++i) {
+        zobristKeys[i] = zobrist_key(i >> 5, static_cast<unsigned char>(i & 31));
+    }
+    return true;
+}
+
+Board::Board(int _height, int _width):
+    height(_height),
+    width(_width),
+    cells(static_cast<std::size_t>(_height) * static_cast<std::size_t>(_width), encode(BlockType::EMPTY, 0)),
+    hash(0)
+{
+}
+
+int Board::get_height() const {
+    return this->height;
+}
+
+int Board::get_width() const {
+    return this->width;
+}
+
+bool Board::contains(int y, int x) const {
+    return y >= 0 && x >= 0 && y < this->height && x < this->width;
+}
+
+BlockData Board::get_block(int y, int x) const {
+    return {this->get_type(y, x), this->get_orientation(y, x)};
+}
+
+void Board::set_block(int y, int x, BlockType type, int orientation) {
+    this->set_cell(y, x, encode(type, orientation % 4));
+}
+
+void Board::set_block(int y, int x, const BlockData &data) {
+    this->set_block(y, x, data.type, data.orientation);
+}
+
+void Board::rotate(int y, int x) {
+    this->set_block(y, x, this->get_type(y, x), this->get_orientation(y, x) + 1);
+}
+
+bool Board::operator==(const Board &other) const {
+    return this->height == other.height && this->width == other.width && this->cells == other.cells;
+}
+
+bool Board::operator!=(const Board &other) const {
+    return !(*this == other);
+}
@@ -0,0 +1,121 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+#include <vector>
+
+#include "pipe.h"
+
+// Plain value model of a game board, one byte per block
+class Board
+{
+ public:
+    static const int DEFAULT_SIZE = 8;
+
+    Board(int _height = DEFAULT_SIZE, int _width = DEFAULT_SIZE);
+
+    int get_height() const;
+    int get_width() const;
+    bool contains(int y, int x) const;
+
+    BlockType get_type(int y, int x) const;
+    int get_orientation(int y, int x) const;
+    int get_direction(int y, int x) const;
+    BlockData get_block(int y, int x) const;
+    void set_block(int y, int x, BlockType type, int orientation);
+    void set_block(int y, int x, const BlockData &data);
+    void rotate(int y, int x);
+
+    // Blocks in row-major order, one encoded byte each
+    const unsigned char *get_cells() const;
+    unsigned char get_cell(int y, int x) const;
+    void set_cell(int y, int x, unsigned char cell);
+    static int cell_direction(unsigned char cell);
+    // Zobrist hash of the blocks, kept up to date on every change
+    uint64_t get_hash() const;
+
+    bool operator==(const Board &other) const;
+    bool operator!=(const Board &other) const;
+
+ private:
+    int height;
+    int width;
+    std::vector<unsigned char> cells;
+    uint64_t hash;
+
+    static unsigned char encode(BlockType type, int orientation);
+    static const int ZOBRIST_BLOCKS = 64;
+    static uint64_t zobristKeys[ZOBRIST_BLOCKS * 32];
+    static const bool zobristFilled;
+    static bool fill_zobrist_keys();
+    static uint64_t zobrist_key(int index, unsigned char cell);
+    static uint64_t zobrist(int index, unsigned char cell);
+    int index(int y, int x) const;
+};
+
+inline int Board::index(int y, int x) const {
+    return y * this->width + x;
+}
+
+inline unsigned char Board::encode(BlockType type, int orientation) {
+    return static_cast<unsigned char>(type | (orientation << 3));
+}
+
+inline BlockType Board::get_type(int y, int x) const {
+    return static_cast<BlockType>(this->cells[this->index(y, x)] & 7);
+}
+
+inline int Board::get_orientation(int y, int x) const {
+    return this->cells[this->index(y, x)] >> 3;
+}
+
+inline const unsigned char *Board::get_cells() const {
+    return this->cells.data();
+}
+
+inline unsigned char Board::get_cell(int y, int x) const {
+    return this->cells[this->index(y, x)];
+}
+
+// One random key per block and cell value, drawn from a hash of the pair so
+// boards of any size are covered. Empty blocks have no key, so a new board
+// hashes to 0 without visiting its blocks.
+inline uint64_t Board::zobrist_key(int index, unsigned char cell) {
+    if (cell == encode(BlockType::EMPTY, 0)) return 0;
+    uint64_t key = (static_cast<uint64_t>(index) << 5 | cell) + 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+// The keys of the first blocks are looked up instead. The table is filled
+// during static initialization; until then its zeros fall back to the hash.
+inline uint64_t Board::zobrist(int index, unsigned char cell) {
+    if (index < ZOBRIST_BLOCKS) {
+        uint64_t key = zobristKeys[index << 5 | cell];
+        if (key != 0) return key;
+    }
+    return zobrist_key(index, cell);
+}
+
+inline void Board::set_cell(int y, int x, unsigned char cell) {
+    int index = this->index(y, x);
+    unsigned char &current = this->cells[index];
+    if (current == cell) return;
+    this->hash ^= zobrist(index, current) ^ zobrist(index, cell);
+    current = cell;
+}
+
+inline uint64_t Board::get_hash() const {
+    return this->hash;
+}
+
+inline int Board::cell_direction(unsigned char cell) {
+    return CELL_DIRECTIONS[cell & 31];
+}
+
+inline int Board::get_direction(int y, int x) const {
+    return pipeDirection(this->get_type(y, x), this->get_orientation(y, x));
+}
+
+#endif // BOARD_H
@@ -0,0 +1,283 @@
+
+#include "bitboard.h"
+#include "bot.h"
+#include "solver.h"
+#include "threadpool.h"
+
+using namespace std;
+
+static const double WIN_SCORE = 1000;
+static const double GAP_WEIGHT = 8;
+
+BotOptions::BotOptions():
+    size(Board::DEFAULT_SIZE),
+    depth(2),
+    samples(8),
+    spawnTypes(SPAWN_TYPES),
+    maxMoves(200),
+    tableBits(16)
+{
+}
+
+TranspositionTable::TranspositionTable(int bits):
+    entries(static_cast<size_t>(1) << bits, Entry{0, 0, -1}),
+    mask((static_cast<uint64_t>(1) << bits) - 1)
+{
+}
+
+bool TranspositionTable::find(uint64_t key, int depth, double &value) const {
+    const Entry &entry = this->entries[key & this->mask];
+    if (entry.key != key || entry.depth != depth) return false;
+    value = entry.value;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, double value) {
+    Entry &entry = this->entries[key & this->mask];
+    entry.key = key;
+    entry.value = value;
+    entry.depth = depth;
+}
+
+// Boards keep their Zobrist hash up to date, spawns and swipes included
+uint64_t TranspositionTable::hash(const Board &board) {
+    return board.get_hash();
+}
+
+FeatureBot::FeatureBot(const BotOptions &_options):
+    options(_options),
+    table(_options.tableBits),
+    nodes(0)
+{
+}
+
+long long FeatureBot::get_nodes() const {
+    return this->nodes;
+}
+
+static const uint64_t FIRST_COLUMN = 0x0101010101010101ULL;
+static const uint64_t LAST_COLUMN = FIRST_COLUMN << (BitBoard::SIZE - 1);
+
+static uint64_t neighbours(uint64_t cells) {
+    return ((cells << 1) & ~FIRST_COLUMN) | ((cells >> 1) & ~LAST_COLUMN) | (cells << 8) | (cells >> 8);
+}
+
+// gap() on an 8x8 board: flood the blocks reachable for free, then step onto
+// the empty cells next to them, one cost at a time
+static int gapBits(const unsigned char *cells) {
+    uint64_t blocks = 0;
+    for (int i = 0; i < BitBoard::SIZE * BitBoard::SIZE; ++i) {
+        if ((cells[i] & 7) != BlockType::EMPTY) blocks |= 1ULL << i;
+    }
+    const uint64_t outlet = 1ULL << (BitBoard::SIZE * BitBoard::SIZE - 1);
+    int cost = (blocks & 1) ? 0 : 1;
+    uint64_t reached = 1;
+    while (true) {
+        uint64_t previous;
+        do {
+            previous = reached;
+            reached |= neighbours(reached) & blocks;
+        } while (reached != previous);
+        if (reached & outlet) return cost;
+        reached |= neighbours(reached) & ~blocks;
+        ++cost;
+    }
+}
+
+// Fewest empty cells on any chain of cells from the inlet to the outlet
+int FeatureBot::gap(const Board &board) {
+    if (board.get_height() == BitBoard::SIZE && board.get_width() == BitBoard::SIZE) {
+        return gapBits(board.get_cells());
+    }
+
+    const int height = board.get_height();
+    const int width = board.get_width();
+    const int size = height * width;
+    const unsigned char *cells = board.get_cells();
+    this->distance.assign(static_cast<size_t>(size), size + 1);
+    this->queue.resize(static_cast<size_t>(size) * 10 + 2);
+
+    // 0-1 BFS: reaching a block is free, reaching an empty cell costs one
+    int head = size * 5 + 1;
+    int tail = head;
+    this->distance[0] = (cells[0] & 7) == BlockType::EMPTY ? 1 : 0;
+    this->queue[tail++] = 0;
+    while (head < tail) {
+        int index = this->queue[head++];
+        int y = index / width;
+        int x = index % width;
+        for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+            int ny = y + deltaY(direction);
+            int nx = x + deltaX(direction);
+            if (ny < 0 || nx < 0 || ny >= height || nx >= width) continue;
+            int next = ny * width + nx;
+            int cost = (cells[next] & 7) == BlockType::EMPTY ? 1 : 0;
+            if (this->distance[index] + cost >= this->distance[next]) continue;
+            this->distance[next] = this->distance[index] + cost;
+            if (cost == 0) {
+                this->queue[--head] = next;
+            } else {
+                this->queue[tail++] = next;
+            }
+        }
+    }
+    return this->distance[size - 1];
+}
+
+int FeatureBot::finish_steps(const Board &board) {
+    if (this->gap(board) != 0) return -1;
+    Solution solution = Solver(board).solve();
+    return solution.solvable ? solution.steps : -1;
+}
+
+double FeatureBot::score(const Board &board) {
+    uint64_t key = TranspositionTable::hash(board);
+    double value;
+    if (this->table.find(key, 0, value)) return value;
+
+    int distance = this->gap(board);
+    if (distance == 0) {
+        Solution solution = Solver(board).solve();
+        if (solution.solvable) {
+            value = WIN_SCORE - solution.steps;
+            this->table.store(key, 0, value);
+            return value;
+        }
+    }
+    int empty = 0;
+    const unsigned char *cells = board.get_cells();
+    for (int i = 0; i < board.get_height() * board.get_width(); ++i) {
+        if ((cells[i] & 7) == BlockType::EMPTY) ++empty;
+    }
+    value = -GAP_WEIGHT * distance + empty;
+    this->table.store(key, 0, value);
+    return value;
+}
+
+double FeatureBot::maxNode(const Board &board, int depth, Random &random) {
+    uint64_t key = TranspositionTable::hash(board);
+    double value;
+    if (this->table.find(key, depth, value)) return value;
+
+    value = -WIN_SCORE * 2;
+    for (int direction = SWIPE_LEFT; direction <= SWIPE_DOWN; ++direction) {
+        Board next = board;
+        swipe(next, static_cast<SwipeDirection>(direction));
+        double result = this->chanceNode(next, depth, random);
+        if (result > value) value = result;
+    }
+    this->table.store(key, depth, value);
+    return value;
+}
+
+// Average over the spawns that may follow, with `depth` swipes still to look at
+double FeatureBot::chanceNode(Board &board, int depth, Random &random) {
+    ++this->nodes;
+    const int width = board.get_width();
+    int empty[Board::DEFAULT_SIZE * Board::DEFAULT_SIZE];
+    vector<int> largeEmpty;
+    int *cells = empty;
+    int emptyCount = 0;
+    if (board.get_height() * width > Board::DEFAULT_SIZE * Board::DEFAULT_SIZE) {
+        largeEmpty.resize(static_cast<size_t>(board.get_height()) * width);
+        cells = largeEmpty.data();
+    }
+    for (int i = 0; i < board.get_height() * width; ++i) {
+        if ((board.get_cells()[i] & 7) == BlockType::EMPTY) cells[emptyCount++] = i;
+    }
+    if (emptyCount == 0) {
+        return depth > 1 ? this->maxNode(board, depth - 1, random) : this->score(board);
+    }
+
+    BlockType types[4];
+    int typeCount = 0;
+    for (int type = 0; type < BlockType::EMPTY; ++type) {
+        if (this->options.spawnTypes & (1 << type)) types[typeCount++] = static_cast<BlockType>(type);
+    }
+    if (typeCount == 0) return this->score(board);
+
+    int spawns = emptyCount * typeCount * 4;
+    bool sampled = this->options.samples > 0 && this->options.samples < spawns;
+    int count = sampled ? this->options.samples : spawns;
+    double total = 0;
+    for (int i = 0; i < count; ++i) {
+        int spawn = sampled ? random.next_int(spawns) : i;
+        int index = cells[spawn / (typeCount * 4)];
+        int y = index / width;
+        int x = index % width;
+        unsigned char original = board.get_cell(y, x);
+        board.set_block(y, x, types[spawn / 4 % typeCount], spawn % 4);
+
+        double value = this->score(board);
+        if (depth > 1 && value < WIN_SCORE / 2) {
+            value = this->maxNode(board, depth - 1, random);
+        }
+        total += value;
+        board.set_cell(y, x, original);
+    }
+    return total / count;
+}
+
+SwipeDirection FeatureBot::choose(const Board &board, Random &random) {
+    SwipeDirection best = SWIPE_LEFT;
+    double bestValue = -WIN_SCORE * 2;
+    for (int direction = SWIPE_LEFT; direction <= SWIPE_DOWN; ++direction) {
+        Board next = board;
+        swipe(next, static_cast<SwipeDirection>(direction));
+        double value = this->chanceNode(next, this->options.depth, random);
+        if (value > bestValue) {
+            bestValue = value;
+            best = static_cast<SwipeDirection>(direction);
+        }
+    }
+    return best;
+}
+
+// A full board the swipes can not change ends the game
+static bool canMove(const Board &board) {
+    const unsigned char *cells = board.get_cells();
+    for (int i = 0; i < board.get_height() * board.get_width(); ++i) {
+        if ((cells[i] & 7) == BlockType::EMPTY) return true;
+    }
+    for (int direction = SWIPE_LEFT; direction <= SWIPE_DOWN; ++direction) {
+        Board next = board;
+        swipe(next, static_cast<SwipeDirection>(direction));
+        if (next != board) return true;
+    }
+    return false;
+}
+
+BotGame playGame(const BotOptions &options, uint64_t seed) {
+    FeatureBot bot{options};
+    Random random{seed};
+    Board board{options.size, options.size};
+    // Same opening as the game window
+    for (int i = 0; i < options.size; ++i) {
+        addRandomPipe(board, random, options.spawnTypes);
+    }
+
+    BotGame game = {false, 0, -1, 0};
+    while (true) {
+        int steps = bot.finish_steps(board);
+        if (steps >= 0) {
+            game.won = true;
+            game.rotations = steps;
+            break;
+        }
+        if (game.swipes >= options.maxMoves || !canMove(board)) break;
+        swipe(board, bot.choose(board, random));
+        addRandomPipe(board, random, options.spawnTypes);
+        ++game.swipes;
+    }
+    game.nodes = bot.get_nodes();
+    return game;
+}
+
+vector<BotGame> playGames(const BotOptions &options, uint64_t seed, int count, int threads) {
+    vector<BotGame> games(static_cast<size_t>(count));
+    ThreadPool pool{threads};
+    pool.for_each(count, [&](int index) {
+        games[index] = playGame(options, Random::derive(seed, static_cast<uint64_t>(index)));
+    });
+    return games;
+}
@@ -0,0 +1,88 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "random.h"
+#include "swipe.h"
+
+struct BotOptions {
+    int size;
+    // Swipes looked ahead, each followed by a spawn
+    int depth;
+    // Spawns averaged at a chance node, 0 for every possible one
+    int samples;
+    int spawnTypes;
+    // Swipes before a game counts as lost
+    int maxMoves;
+    // The transposition table holds 2^tableBits positions
+    int tableBits;
+
+    BotOptions();
+};
+
+struct BotGame {
+    bool won;
+    int swipes;
+    // Rotations the solver needs once the water can reach the outlet
+    int rotations;
+    long long nodes;
+};
+
+// Positions already searched, keyed by a hash of the board. Entries are
+// replaced on collision, so a lookup only ever costs one probe.
+class TranspositionTable
+{
+ public:
+    explicit TranspositionTable(int bits);
+
+    bool find(uint64_t key, int depth, double &value) const;
+    void store(uint64_t key, int depth, double value);
+    static uint64_t hash(const Board &board);
+
+ private:
+    struct Entry {
+        uint64_t key;
+        double value;
+        int depth;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t mask;
+};
+
+// Expectimax player for the feature mode. Swipes are max nodes, the spawn that
+// follows is a chance node over every empty cell, spawn type and orientation.
+// A board is scored by the solver once a chain of blocks joins the inlet to the
+// outlet, and by the number of empty cells such a chain still needs otherwise.
+class FeatureBot
+{
+ public:
+    explicit FeatureBot(const BotOptions &_options);
+
+    SwipeDirection choose(const Board &board, Random &random);
+    // Rotations to finish, -1 while the board can not be solved
+    int finish_steps(const Board &board);
+    long long get_nodes() const;
+
+ private:
+    BotOptions options;
+    TranspositionTable table;
+    long long nodes;
+    std::vector<int> distance;
+    std::vector<int> queue;
+
+    int gap(const Board &board);
+    double score(const Board &board);
+    double maxNode(const Board &board, int depth, Random &random);
+    double chanceNode(Board &board, int depth, Random &random);
+};
+
+// A whole game from the opening spawns, reproducible from the seed
+BotGame playGame(const BotOptions &options, uint64_t seed);
+// Game i uses Random::derive(seed, i), whatever the thread count
+std::vector<BotGame> playGames(const BotOptions &options, uint64_t seed, int count, int threads = 0);
+
+#endif // BOT_H
@@ -0,0 +1,15 @@
+# Link against the core library, see core.pro
+INCLUDEPATH += $$PWD
+tracing: DEFINES += PIPES_TRACING
+
+# debug_and_release builds on Windows put the library in debug/ or release/,
+# and MSVC names it pipescore.lib
+win32:CONFIG(release, debug|release): PIPESCORE_DIR = $$shadowed($$PWD)/release
+else:win32:CONFIG(debug, debug|release): PIPESCORE_DIR = $$shadowed($$PWD)/debug
+else: PIPESCORE_DIR = $$shadowed($$PWD)
+
+LIBS += -L$$PIPESCORE_DIR -lpipescore
+
+win32-g++: PRE_TARGETDEPS += $$PIPESCORE_DIR/libpipescore.a
+else:win32: PRE_TARGETDEPS += $$PIPESCORE_DIR/pipescore.lib
+else: PRE_TARGETDEPS += $$PIPESCORE_DIR/libpipescore.a
@@ -0,0 +1,66 @@
+#-------------------------------------------------
+#
+# Game rules without any Qt dependency
+#
+#-------------------------------------------------
+
+TEMPLATE = lib
+CONFIG += staticlib c++11 thread
+CONFIG -= qt
+
+TARGET = pipescore
+
+# qmake CONFIG+=tracing turns on the timing spans, see trace.h
+tracing: DEFINES += PIPES_TRACING
+# qmake CONFIG+=avx2 widens the batch evaluator to AVX2, see batchevaluator.h
+avx2: QMAKE_CXXFLAGS += -mavx2
+
+SOURCES += board.cpp \
+    batchevaluator.cpp \
+    bigcount.cpp \
+    bitboard.cpp \
+    bot.cpp \
+    counter.cpp \
+    evaluator.cpp \
+    generator.cpp \
+    history.cpp \
+    hint.cpp \
+    levelpack.cpp \
+    levelparser.cpp \
+    levelsource.cpp \
+    liveflow.cpp \
+    parallelevaluator.cpp \
+    recording.cpp \
+    recordstore.cpp \
+    session.cpp \
+    snapshot.cpp \
+    solver.cpp \
+    swipe.cpp \
+    threadpool.cpp \
+    trace.cpp
+
+HEADERS += pipe.h \
+    batchevaluator.h \
+    bigcount.h \
+    board.h \
+    bitboard.h \
+    bot.h \
+    counter.h \
+    evaluator.h \
+    generator.h \
+    history.h \
+    hint.h \
+    levelpack.h \
+    levelparser.h \
+    levelsource.h \
+    liveflow.h \
+    parallelevaluator.h \
+    random.h \
+    recording.h \
+    recordstore.h \
+    session.h \
+    snapshot.h \
+    solver.h \
+    swipe.h \
+    threadpool.h \
+    trace.h
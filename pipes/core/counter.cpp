@@ -0,0 +1,210 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "counter.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace {
+
+// Profile slot x holds the pipe end entering block (y, x) from above, slot
+// width the end entering the current block from the left. 0 is no pipe end,
+// 1 the network of the inlet, and the others are numbered in order of first
+// appearance so equal profiles compare equal.
+typedef string Profile;
+
+const char INLET = 1;
+const char FRESH = 127;
+const uint32_t NO_STATE = 0xffffffffu;
+
+void normalize(Profile &profile) {
+    char labels[128] = {0};
+    char next = INLET + 1;
+    labels[static_cast<int>(INLET)] = INLET;
+    for (size_t i = 0; i < profile.size(); ++i) {
+        char &label = profile[i];
+        if (label == 0) continue;
+        if (labels[static_cast<int>(label)] == 0) labels[static_cast<int>(label)] = next++;
+        label = labels[static_cast<int>(label)];
+    }
+}
+
+// Profiles met after the same number of blocks, each once with its counts.
+// The profiles sit back to back in one buffer behind an open-addressing index.
+class Sweep
+{
+ public:
+    explicit Sweep(size_t _stride, size_t expected = 0):
+        stride(_stride),
+        mask(15)
+    {
+        while (this->mask + 1 < expected * 2) this->mask = this->mask * 2 + 1;
+        this->index.assign(this->mask + 1, NO_STATE);
+    }
+
+    size_t size() const {
+        return this->counts.size();
+    }
+
+    const char *profile(size_t state) const {
+        return &this->profiles[state * this->stride];
+    }
+
+    const SolutionCount &count(size_t state) const {
+        return this->counts[state];
+    }
+
+    // The counts of `profile`, zero when it was never added
+    SolutionCount find(const char *profile) const {
+        size_t slot = this->lookup(profile);
+        if (this->index[slot] == NO_STATE) return SolutionCount();
+        return this->counts[this->index[slot]];
+    }
+
+    void add(const char *profile, const SolutionCount &count, uint32_t orientations) {
+        size_t slot = this->lookup(profile);
+        if (this->index[slot] == NO_STATE) {
+            this->index[slot] = static_cast<uint32_t>(this->counts.size());
+            this->profiles.insert(this->profiles.end(), profile, profile + this->stride);
+            this->counts.push_back(count);
+            this->counts.back().assignments *= orientations;
+            if (this->counts.size() * 2 > this->mask) this->grow();
+            return;
+        }
+        SolutionCount &total = this->counts[this->index[slot]];
+        total.networks += count.networks;
+        BigCount assignments = count.assignments;
+        assignments *= orientations;
+        total.assignments += assignments;
+    }
+
+ private:
+    size_t stride;
+    size_t mask;
+    std::vector<uint32_t> index;
+    std::vector<char> profiles;
+    std::vector<SolutionCount> counts;
+
+    size_t hash(const char *profile) const {
+        uint64_t value = 14695981039346656037ull;
+        for (size_t i = 0; i < this->stride; ++i) {
+            value = (value ^ static_cast<unsigned char>(profile[i])) * 1099511628211ull;
+        }
+        return static_cast<size_t>(value ^ (value >> 32));
+    }
+
+    size_t lookup(const char *profile) const {
+        size_t slot = this->hash(profile) & this->mask;
+        while (this->index[slot] != NO_STATE
+               && memcmp(&this->profiles[this->index[slot] * this->stride], profile, this->stride) != 0) {
+            slot = (slot + 1) & this->mask;
+        }
+        return slot;
+    }
+
+    void grow() {
+        this->mask = this->mask * 2 + 1;
+        this->index.assign(this->mask + 1, NO_STATE);
+        for (size_t state = 0; state < this->counts.size(); ++state) {
+            size_t slot = this->hash(this->profile(state)) & this->mask;
+            while (this->index[slot] != NO_STATE) slot = (slot + 1) & this->mask;
+            this->index[slot] = static_cast<uint32_t>(state);
+        }
+    }
+};
+
+}
+
+SolutionCounter::SolutionCounter(const Board &_board):
+    board(_board),
+    height(_board.get_height()),
+    width(_board.get_width())
+{
+}
+
+SolutionCount SolutionCounter::count() {
+    PIPES_TRACE_SCOPE("SolutionCounter::count");
+    const int width = this->width;
+    SolutionCount none = {BigCount(), BigCount()};
+    if (this->height == 0 || width == 0) return none;
+
+    const size_t stride = static_cast<size_t>(width) + 1;
+    Sweep current(stride);
+    Profile start(stride, 0);
+    start[width] = INLET;
+    SolutionCount one = {BigCount(1), BigCount(1)};
+    current.add(start.data(), one, 1);
+
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            BlockType type = this->board.get_type(y, x);
+            bool last = y == this->height - 1 && x == width - 1;
+
+            // Each distinct direction mask once, with the orientations showing it
+            int masks[4];
+            uint32_t orientations[4];
+            int maskCount = 0;
+            for (int orientation = 0; type != BlockType::EMPTY && orientation < 4; ++orientation) {
+                int mask = pipeDirection(type, orientation);
+                int i = 0;
+                while (i < maskCount && masks[i] != mask) ++i;
+                if (i == maskCount) {
+                    masks[maskCount] = mask;
+                    orientations[maskCount++] = 0;
+                }
+                ++orientations[i];
+            }
+
+            Sweep next(stride, current.size());
+            for (size_t state = 0; state < current.size(); ++state) {
+                const char *profile = current.profile(state);
+                const SolutionCount &count = current.count(state);
+                char left = profile[width];
+                char up = profile[x];
+
+                // Dry: nothing may flow in
+                if (left == 0 && up == 0) {
+                    next.add(profile, count, type == BlockType::EMPTY ? 1 : 4);
+                }
+
+                for (int i = 0; i < maskCount; ++i) {
+                    int mask = masks[i];
+                    if (((mask & LEFT) != 0) != (left != 0) || ((mask & UP) != 0) != (up != 0)) continue;
+                    // Only the outlet may be open past the border
+                    if ((mask & RIGHT) && x == width - 1 && !last) continue;
+                    if ((mask & DOWN) && y == this->height - 1) continue;
+
+                    Profile joined(profile, stride);
+                    char label = FRESH;
+                    if (left != 0 && up != 0) {
+                        label = min(left, up);
+                        char merged = max(left, up);
+                        for (size_t slot = 0; slot < joined.size(); ++slot) {
+                            if (joined[slot] == merged) joined[slot] = label;
+                        }
+                    } else if (left != 0) {
+                        label = left;
+                    } else if (up != 0) {
+                        label = up;
+                    }
+                    joined[x] = (mask & DOWN) ? label : 0;
+                    joined[width] = (mask & RIGHT) ? label : 0;
+
+                    // A network with no open end left is closed: dry if it is
+                    // not the inlet's, and short of the outlet if it is
+                    if (joined.find(label) == string::npos) continue;
+                    normalize(joined);
+                    next.add(joined.data(), count, orientations[i]);
+                }
+            }
+            swap(current, next);
+        }
+    }
+
+    // Everything joined the inlet's network, which leaves through the outlet
+    Profile finish(stride, 0);
+    finish[width] = INLET;
+    return current.find(finish.data());
+}
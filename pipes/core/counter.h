@@ -0,0 +1,33 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include "bigcount.h"
+#include "board.h"
+
+struct SolutionCount {
+    // Distinct water networks reaching the outlet: the wet blocks and the
+    // directions they show. Dry blocks may point anywhere.
+    BigCount networks;
+    // Orientations of every block, 0 to 3 each, that evaluate to CONNECTED
+    BigCount assignments;
+};
+
+// Exact solution counter. The board is swept one block at a time in row-major
+// order; the state is the profile of pipe ends crossing the line between the
+// swept and unswept blocks, each labelled with the network it belongs to, so
+// two sweeps that left the same ends joined the same way are merged. The work
+// grows linearly with the number of rows and exponentially only with the width.
+class SolutionCounter
+{
+ public:
+    explicit SolutionCounter(const Board &_board);
+
+    SolutionCount count();
+
+ private:
+    const Board &board;
+    int height;
+    int width;
+};
+
+#endif // COUNTER_H
@@ -0,0 +1,174 @@
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+
+#include "evaluator.h"
+#include "trace.h"
+#include "bitboard.h"
+#include "parallelevaluator.h"
+
+using namespace std;
+
+static BFSResult evaluateBoard(const Board &board, vector<int> *layers) {
+    const int height = board.get_height();
+    const int width = board.get_width();
+    vector<bool> travelled(static_cast<std::size_t>(height) * static_cast<std::size_t>(width), false);
+    bool leaked = false;
+    bool connected = false;
+    queue<BFSNode> frontier;
+    // initial frontier
+    frontier.push({LEFT, 0, 0, 0});
+
+    int layerCount = 0;
+    while (!frontier.empty()) {
+        BFSNode node = frontier.front();
+        frontier.pop();
+
+        // outlet position
+        if (node.x == width && node.y == height - 1) {
+            connected = true;
+            continue;
+        }
+
+        // Check range
+        if (!board.contains(node.y, node.x)) {
+            leaked = true;
+            continue;
+        }
+
+        int blockDirection = board.get_direction(node.y, node.x);
+
+        // Cannot flow from
+        if ((node.from & blockDirection) == 0) {
+            leaked = true;
+            continue;
+        }
+        blockDirection -= node.from;
+
+        // Check travelled
+        int index = node.y * width + node.x;
+        if (travelled[index]) {
+            continue;
+        }
+
+        travelled[index] = true;
+        if (layers != nullptr) {
+            (*layers)[index] = node.layer;
+        }
+        layerCount = node.layer + 1;
+
+        for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+            if (direction & blockDirection) {
+                frontier.push({oppositeDirection(direction), node.y + deltaY(direction), node.x + deltaX(direction), node.layer + 1});
+            }
+        }
+    }
+
+    BFSStatus status = BFSStatus::STUCK;
+    if (leaked) {
+        status = BFSStatus::LEAKAGE;
+    } else if (connected) {
+        status = BFSStatus::CONNECTED;
+    }
+    return {status, layerCount + 1};
+}
+
+// The same search on a square board whose size is known at compile time:
+// bounds and row strides are constants and the frontier is a fixed array, so
+// nothing is allocated
+template <int N>
+static BFSResult evaluateSized(const Board &board, vector<int> *layers) {
+    const unsigned char *cells = board.get_cells();
+    // y << 12 | x << 4 | the direction the water comes from, with y and x one
+    // higher so the blocks around the board fit; a wet block sends water on
+    // through at most three ends
+    uint32_t frontier[3 * N * N + 1];
+    bool travelled[N * N] = {};
+    int head = 0;
+    int tail = 0;
+    frontier[tail++] = 1 << 12 | 1 << 4 | LEFT;
+    bool leaked = false;
+    bool connected = false;
+    int layerCount = 0;
+    for (int layer = 0; head < tail; ++layer) {
+        for (const int end = tail; head < end; ++head) {
+            int y = static_cast<int>(frontier[head] >> 12) - 1;
+            int x = static_cast<int>(frontier[head] >> 4 & 255) - 1;
+            int from = static_cast<int>(frontier[head] & 15);
+
+            // outlet position
+            if (x == N && y == N - 1) {
+                connected = true;
+                continue;
+            }
+            if (static_cast<unsigned>(y) >= static_cast<unsigned>(N) || static_cast<unsigned>(x) >= static_cast<unsigned>(N)) {
+                leaked = true;
+                continue;
+            }
+            int index = y * N + x;
+            int blockDirection = Board::cell_direction(cells[index]);
+            if ((from & blockDirection) == 0) {
+                leaked = true;
+                continue;
+            }
+            if (travelled[index]) {
+                continue;
+            }
+            travelled[index] = true;
+            if (layers != nullptr) {
+                (*layers)[index] = layer;
+            }
+            layerCount = layer + 1;
+
+            blockDirection -= from;
+            for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+                if (direction & blockDirection) {
+                    frontier[tail++] = static_cast<uint32_t>(y + 1 + deltaY(direction)) << 12
+                                     | static_cast<uint32_t>(x + 1 + deltaX(direction)) << 4
+                                     | static_cast<uint32_t>(oppositeDirection(direction));
+                }
+            }
+        }
+    }
+
+    BFSStatus status = BFSStatus::STUCK;
+    if (leaked) {
+        status = BFSStatus::LEAKAGE;
+    } else if (connected) {
+        status = BFSStatus::CONNECTED;
+    }
+    return {status, layerCount + 1};
+}
+
+BFSResult evaluate(const Board &board, vector<int> *layers) {
+    PIPES_TRACE_SCOPE("evaluate");
+    if (layers != nullptr) {
+        layers->assign(static_cast<std::size_t>(board.get_height()) * static_cast<std::size_t>(board.get_width()), -1);
+    }
+
+    if (board.get_height() != BitBoard::SIZE || board.get_width() != BitBoard::SIZE) {
+        if (board.get_height() == board.get_width()) {
+            switch (board.get_height()) {
+            case 16:
+                return evaluateSized<16>(board, layers);
+            case 32:
+                return evaluateSized<32>(board, layers);
+            }
+        }
+        if (layers == nullptr && board.get_height() * board.get_width() >= PARALLEL_EVALUATION_BLOCKS) {
+            return evaluateParallel(board);
+        }
+        return evaluateBoard(board, layers);
+    }
+
+    uint64_t layerBits[BitBoard::MAX_LAYERS];
+    BFSResult result = evaluateBits(BitBoard(board), layers != nullptr ? layerBits : nullptr);
+    if (layers != nullptr) {
+        for (int layer = 0; layer + 1 < result.cycles; ++layer) {
+            for (uint64_t bits = layerBits[layer]; bits; bits &= bits - 1) {
+                (*layers)[lowestBit(bits)] = layer;
+            }
+        }
+    }
+    return result;
+}
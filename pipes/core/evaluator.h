@@ -0,0 +1,28 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <vector>
+
+#include "board.h"
+
+struct BFSNode {
+    int from, y, x, layer;
+};
+
+enum BFSStatus {
+    CONNECTED, LEAKAGE, STUCK
+};
+
+struct BFSResult {
+    BFSStatus status;
+    int cycles;
+};
+
+// Flow water from the inlet left of (0, 0) towards the outlet right of the
+// bottom-right block. `layers` receives, for each block y * width + x, the BFS
+// step at which the water reaches it, or -1 if it stays dry; `cycles` is the
+// number of steps plus one. Large boards are evaluated in parallel when no
+// layers are asked for, see evaluateParallel().
+BFSResult evaluate(const Board &board, std::vector<int> *layers = nullptr);
+
+#endif // EVALUATOR_H
@@ -0,0 +1,188 @@
+#include <cstdlib>
+
+#include "generator.h"
+#include "random.h"
+#include "solver.h"
+#include "threadpool.h"
+
+using namespace std;
+
+GeneratorOptions::GeneratorOptions():
+    height(Board::DEFAULT_SIZE),
+    width(Board::DEFAULT_SIZE),
+    difficulty(30),
+    tolerance(8),
+    detours(2),
+    emptyPercent(40),
+    attempts(16)
+{
+}
+
+LevelGenerator::LevelGenerator(const GeneratorOptions &_options):
+    options(_options)
+{
+}
+
+// Pipe ends of every block on the network, built by joining neighbours
+class Network
+{
+ public:
+    Network(int _height, int _width):
+        height(_height),
+        width(_width),
+        ends(static_cast<size_t>(_height) * _width, 0)
+    {
+    }
+
+    int neighbour(int index, int direction) const {
+        int y = index / this->width + deltaY(direction);
+        int x = index % this->width + deltaX(direction);
+        if (y < 0 || x < 0 || y >= this->height || x >= this->width) return -1;
+        return y * this->width + x;
+    }
+
+    void join(int index, int direction) {
+        this->ends[index] |= direction;
+        this->ends[this->neighbour(index, direction)] |= oppositeDirection(direction);
+    }
+
+    int height;
+    int width;
+    vector<int> ends;
+};
+
+static int directionTo(const Network &network, int from, int to) {
+    for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+        if (network.neighbour(from, direction) == to) return direction;
+    }
+    return 0;
+}
+
+// Loop-erased random walk from the inlet block to the outlet block
+static vector<int> randomPath(const Network &network, Random &random) {
+    const int last = network.height * network.width - 1;
+    vector<int> position(network.ends.size(), -1);
+    vector<int> path(1, 0);
+    position[0] = 0;
+    while (path.back() != last) {
+        int next = -1;
+        while (next < 0) {
+            next = network.neighbour(path.back(), 1 << random.next_int(4));
+        }
+        if (position[next] >= 0) {
+            // Erase the loop just closed
+            while (path.back() != next) {
+                position[path.back()] = -1;
+                path.pop_back();
+            }
+        } else {
+            position[next] = static_cast<int>(path.size());
+            path.push_back(next);
+        }
+    }
+    return path;
+}
+
+static BlockType typeOf(int ends) {
+    int count = 0;
+    for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+        if (ends & direction) ++count;
+    }
+    if (count == 4) return BlockType::CROSS;
+    if (count == 3) return BlockType::TJUNCTION;
+    if (ends == (LEFT | RIGHT) || ends == (UP | DOWN)) return BlockType::STRAIGHT;
+    return BlockType::TURN;
+}
+
+static int orientationOf(BlockType type, int ends) {
+    for (int orientation = 0; orientation < 4; ++orientation) {
+        if (pipeDirection(type, orientation) == ends) return orientation;
+    }
+    return 0;
+}
+
+static Board buildLevel(const GeneratorOptions &options, Random &random, int scramblePercent) {
+    Network network{options.height, options.width};
+    vector<int> path = randomPath(network, random);
+    vector<bool> used(network.ends.size(), false);
+    for (size_t i = 0; i < path.size(); ++i) {
+        used[path[i]] = true;
+        if (i + 1 < path.size()) {
+            network.join(path[i], directionTo(network, path[i], path[i + 1]));
+        }
+    }
+    network.ends[0] |= LEFT;
+    network.ends[path.back()] |= RIGHT;
+
+    // Detour around a path step through two free blocks beside it
+    for (int detour = 0, tries = 0; path.size() > 1 && detour < options.detours && tries < 64 * options.detours; ++tries) {
+        size_t step = static_cast<size_t>(random.next_int(static_cast<int>(path.size()) - 1));
+        int a = path[step];
+        int b = path[step + 1];
+        int along = directionTo(network, a, b);
+        int side = rotateDirection(along);
+        if (random.next_int(2)) side = oppositeDirection(side);
+        int c = network.neighbour(a, side);
+        int d = network.neighbour(b, side);
+        if (c < 0 || d < 0 || used[c] || used[d]) continue;
+        network.join(a, side);
+        network.join(c, along);
+        network.join(d, oppositeDirection(side));
+        used[c] = used[d] = true;
+        ++detour;
+    }
+
+    Board board{options.height, options.width};
+    for (int index = 0; index < options.height * options.width; ++index) {
+        int y = index / options.width;
+        int x = index % options.width;
+        BlockType type;
+        int orientation;
+        if (used[index]) {
+            type = typeOf(network.ends[index]);
+            orientation = orientationOf(type, network.ends[index]);
+            if (random.next_int(100) < scramblePercent) {
+                orientation = random.next_int(4);
+            }
+        } else {
+            // Decoy
+            type = random.next_int(100) < options.emptyPercent ? BlockType::EMPTY
+                                                               : static_cast<BlockType>(random.next_int(4));
+            orientation = random.next_int(4);
+        }
+        board.set_block(y, x, type, orientation);
+    }
+    return board;
+}
+
+GeneratedLevel LevelGenerator::generate(uint64_t seed) const {
+    Random random{seed};
+    GeneratedLevel best{Board(this->options.height, this->options.width), -1};
+    int scramblePercent = 100;
+    for (int attempt = 0; attempt < this->options.attempts; ++attempt) {
+        Board board = buildLevel(this->options, random, scramblePercent);
+        Solution solution = Solver(board).solve();
+        int miss = abs(solution.steps - this->options.difficulty);
+        if (best.steps < 0 || miss < abs(best.steps - this->options.difficulty)) {
+            best.board = board;
+            best.steps = solution.steps;
+        }
+        if (miss <= this->options.tolerance) break;
+        // Scramble less when too hard; longer paths come from other walks
+        if (solution.steps > this->options.difficulty && scramblePercent > 10) {
+            scramblePercent = scramblePercent * this->options.difficulty / solution.steps;
+        } else if (solution.steps < this->options.difficulty) {
+            scramblePercent = 100;
+        }
+    }
+    return best;
+}
+
+vector<GeneratedLevel> LevelGenerator::generate(uint64_t seed, int count, int threads) const {
+    vector<GeneratedLevel> levels(static_cast<size_t>(count), GeneratedLevel{Board(), -1});
+    ThreadPool pool{threads};
+    pool.for_each(count, [&](int index) {
+        levels[index] = this->generate(Random::derive(seed, static_cast<uint64_t>(index)));
+    });
+    return levels;
+}
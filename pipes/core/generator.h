@@ -0,0 +1,48 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+struct GeneratorOptions {
+    int height;
+    int width;
+    // Target minimum number of rotations, and how far off a level may be
+    int difficulty;
+    int tolerance;
+    // Detours around the main path, each adding two T-junctions
+    int detours;
+    // Share of the blocks off the pipe network left empty, in percent
+    int emptyPercent;
+    // Levels retried before settling for the closest one
+    int attempts;
+
+    GeneratorOptions();
+};
+
+struct GeneratedLevel {
+    Board board;
+    // Solver optimum, always reachable
+    int steps;
+};
+
+// Builds solvable levels: a loop-erased random walk joins the inlet to the
+// outlet, detours turn parts of it into T-junction loops (crosses where two
+// meet), the remaining blocks are filled with decoys and the orientations are
+// scrambled. The same seed always gives the same level.
+class LevelGenerator
+{
+ public:
+    explicit LevelGenerator(const GeneratorOptions &_options);
+
+    GeneratedLevel generate(uint64_t seed) const;
+    // Level i comes from Random::derive(seed, i), whatever the thread count
+    std::vector<GeneratedLevel> generate(uint64_t seed, int count, int threads = 0) const;
+
+ private:
+    GeneratorOptions options;
+};
+
+#endif // GENERATOR_H
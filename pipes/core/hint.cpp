@@ -0,0 +1,102 @@
+#include <climits>
+
+#include "evaluator.h"
+#include "hint.h"
+#include "solver.h"
+#include "trace.h"
+
+using namespace std;
+
+HintEngine::HintEngine():
+    height(0),
+    width(0)
+{
+}
+
+// Rotating keeps every block type, anything else means a new board
+bool HintEngine::same_blocks(const Board &board) const {
+    if (board.get_height() != this->height || board.get_width() != this->width) return false;
+    const unsigned char *cells = board.get_cells();
+    for (size_t i = 0; i < this->types.size(); ++i) {
+        if ((cells[i] & 7) != this->types[i]) return false;
+    }
+    return true;
+}
+
+// Clockwise rotations for the block to show `mask`, -1 if it never can
+int HintEngine::rotations(BlockType type, int orientation, int mask) {
+    for (int step = 0; step < 4; ++step) {
+        if (pipeDirection(type, (orientation + step) % 4) == mask) return step;
+    }
+    return -1;
+}
+
+int HintEngine::cost_to_target(const Board &board) const {
+    int total = 0;
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) {
+            int mask = this->targetMasks[y * this->width + x];
+            if (mask < 0) continue;
+            int step = rotations(board.get_type(y, x), board.get_orientation(y, x), mask);
+            if (step < 0) return -1;
+            total += step;
+        }
+    }
+    return total;
+}
+
+void HintEngine::set_target(const Board &board, const vector<int> &orientations) {
+    this->height = board.get_height();
+    this->width = board.get_width();
+    Board target = board;
+    this->types.resize(static_cast<size_t>(this->height) * this->width);
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) {
+            int index = y * this->width + x;
+            this->types[index] = static_cast<unsigned char>(board.get_type(y, x));
+            target.set_block(y, x, board.get_type(y, x), orientations[index]);
+        }
+    }
+
+    // The solver only fixes the blocks the water reaches, the rest may point anywhere
+    evaluate(target, &this->targetLayers);
+    this->targetMasks.assign(this->types.size(), -1);
+    for (size_t index = 0; index < this->types.size(); ++index) {
+        if (this->targetLayers[index] >= 0) this->targetMasks[index] = Board::cell_direction(target.get_cells()[index]);
+    }
+}
+
+Hint HintEngine::hint(const Board &board) {
+    PIPES_TRACE_SCOPE("HintEngine::hint");
+    int bound = this->same_blocks(board) ? this->cost_to_target(board) : -1;
+    if (bound == 0) return {true, -1, -1, 0, 0};
+
+    Solution solution = Solver(board).solve(bound);
+    int remaining = bound;
+    if (solution.solvable) {
+        this->set_target(board, solution.orientations);
+        remaining = solution.steps;
+    } else if (bound < 0) {
+        this->height = this->width = 0;
+        this->types.clear();
+        return {false, -1, -1, 0, -1};
+    }
+    if (remaining == 0) return {true, -1, -1, 0, 0};
+
+    // Follow the water: the first block on its way that still needs turning
+    Hint hint = {true, -1, -1, 0, remaining};
+    int layer = INT_MAX;
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) {
+            int index = y * this->width + x;
+            if (this->targetMasks[index] < 0 || this->targetLayers[index] >= layer) continue;
+            int step = rotations(board.get_type(y, x), board.get_orientation(y, x), this->targetMasks[index]);
+            if (step == 0) continue;
+            layer = this->targetLayers[index];
+            hint.y = y;
+            hint.x = x;
+            hint.clicks = step;
+        }
+    }
+    return hint;
+}
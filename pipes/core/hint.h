@@ -0,0 +1,44 @@
+#ifndef HINT_H
+#define HINT_H
+
+#include <vector>
+
+#include "board.h"
+
+struct Hint {
+    // False when no rotations can connect the board
+    bool solvable;
+    // Block to rotate next, -1 when the board is already solved
+    int y;
+    int x;
+    // Clicks on that block, and on the whole board, to reach the optimum
+    int clicks;
+    int remaining;
+};
+
+// Next best rotation for a board in play. The last optimal target is kept:
+// while the player only rotates blocks, reaching that target again bounds the
+// search, so the solver only has to look for something strictly cheaper.
+class HintEngine
+{
+ public:
+    HintEngine();
+
+    Hint hint(const Board &board);
+
+ private:
+    int height;
+    int width;
+    std::vector<unsigned char> types;
+    // Direction mask of each block in the target, -1 where the water never goes
+    std::vector<int> targetMasks;
+    // Step at which the water reaches each block in the target
+    std::vector<int> targetLayers;
+
+    bool same_blocks(const Board &board) const;
+    static int rotations(BlockType type, int orientation, int mask);
+    int cost_to_target(const Board &board) const;
+    void set_target(const Board &board, const std::vector<int> &orientations);
+};
+
+#endif // HINT_H
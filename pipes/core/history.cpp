@@ -0,0 +1,96 @@
+#include <algorithm>
+
+#include "history.h"
+#include "snapshot.h"
+
+using namespace std;
+
+const int History::ALL_BLOCKS;
+const uint32_t History::SNAPSHOT;
+
+History::History():
+    position(0),
+    snapshotPosition(0),
+    words(0)
+{
+}
+
+void History::clear() {
+    this->moves.clear();
+    this->snapshots.clear();
+    this->position = 0;
+    this->snapshotPosition = 0;
+}
+
+// A new move drops whatever could have been redone
+void History::truncate() {
+    this->moves.resize(this->position);
+    this->snapshots.resize(this->snapshotPosition * this->words);
+}
+
+void History::add_rotation(int y, int x) {
+    this->truncate();
+    this->moves.push_back(static_cast<uint32_t>(y) << 16 | static_cast<uint32_t>(x));
+    ++this->position;
+}
+
+void History::add_snapshot(const Board &before) {
+    this->truncate();
+    this->words = packedWords(before.get_height(), before.get_width());
+    this->snapshots.resize((this->snapshotPosition + 1) * this->words);
+    packBoard(before, &this->snapshots[this->snapshotPosition * this->words]);
+    this->moves.push_back(SNAPSHOT);
+    ++this->position;
+    ++this->snapshotPosition;
+}
+
+bool History::can_undo() const {
+    return this->position > 0;
+}
+
+bool History::can_redo() const {
+    return this->position < this->moves.size();
+}
+
+void History::swap_snapshot(Board &board, size_t snapshot) {
+    uint64_t *stored = &this->snapshots[snapshot * this->words];
+    this->scratch.resize(this->words);
+    packBoard(board, this->scratch.data());
+    unpackBoard(stored, board);
+    copy(this->scratch.begin(), this->scratch.end(), stored);
+}
+
+bool History::undo(Board &board, int *block) {
+    if (!this->can_undo()) return false;
+    uint32_t move = this->moves[--this->position];
+    if (move == SNAPSHOT) {
+        this->swap_snapshot(board, --this->snapshotPosition);
+        if (block != nullptr) *block = ALL_BLOCKS;
+        return true;
+    }
+    int y = static_cast<int>(move >> 16);
+    int x = static_cast<int>(move & 0xffff);
+    // Three more turns bring the block back
+    board.set_block(y, x, board.get_type(y, x), board.get_orientation(y, x) + 3);
+    if (block != nullptr) *block = y * board.get_width() + x;
+    return true;
+}
+
+bool History::redo(Board &board, int *block) {
+    if (!this->can_redo()) return false;
+    uint32_t move = this->moves[this->position++];
+    if (move == SNAPSHOT) {
+        this->swap_snapshot(board, this->snapshotPosition++);
+        if (block != nullptr) *block = ALL_BLOCKS;
+        return true;
+    }
+    int y = static_cast<int>(move >> 16);
+    int x = static_cast<int>(move & 0xffff);
+    board.rotate(y, x);
+    if (block != nullptr) *block = y * board.get_width() + x;
+    return true;
+}
+
+size_t History::get_bytes() const {
+    return this->moves.size() * sizeof(uint32_t) + this->snapshots.size() * sizeof(uint64_t);
+}
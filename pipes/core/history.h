@@ -0,0 +1,54 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+// Undo and redo for one board, without limit. A rotation is kept as the index
+// of its block; a move that changes many blocks at once, a swipe with its
+// spawn, keeps a packed snapshot of the board on the other side of the move,
+// which undo and redo swap with the board. Either way a step costs the same
+// however long the game, and a thousand moves fit in a few kilobytes.
+class History
+{
+ public:
+    // The whole board may have changed
+    static const int ALL_BLOCKS = -1;
+
+    History();
+
+    void clear();
+    // Call after rotating the block
+    void add_rotation(int y, int x);
+    // Call before a move that changes many blocks, with the board as it was
+    void add_snapshot(const Board &before);
+
+    bool can_undo() const;
+    bool can_redo() const;
+    // `block` receives y * width + x of the changed block, or ALL_BLOCKS
+    bool undo(Board &board, int *block = nullptr);
+    bool redo(Board &board, int *block = nullptr);
+
+    // Bytes used by the moves, for the memory budget
+    std::size_t get_bytes() const;
+
+ private:
+    static const uint32_t SNAPSHOT = 0xffffffffu;
+
+    // y << 16 | x of the block per move, or SNAPSHOT; the first `position` are done
+    std::vector<uint32_t> moves;
+    std::size_t position;
+    // Packed boards of the snapshot moves, in order, `words` each
+    std::vector<uint64_t> snapshots;
+    std::size_t snapshotPosition;
+    int words;
+    std::vector<uint64_t> scratch;
+
+    void truncate();
+    void swap_snapshot(Board &board, std::size_t snapshot);
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,241 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "levelpack.h"
+
+using namespace std;
+
+static const char MAGIC[8] = {'P', 'I', 'P', 'E', 'P', 'A', 'C', 'K'};
+static const unsigned char EMPTY_RUN = 0x80;
+static const int MAX_RUN = 0x80;
+static const int MAX_SIZE = 4096;
+
+static uint32_t read16(const unsigned char *data) {
+    return data[0] | (data[1] << 8);
+}
+
+static uint32_t read32(const unsigned char *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static void write16(vector<unsigned char> &out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+}
+
+static void write32(vector<unsigned char> &out, uint32_t value) {
+    write16(out, value);
+    write16(out, value >> 16);
+}
+
+LevelPack::LevelPack():
+    data(nullptr),
+    size(0),
+    mapping(nullptr),
+    mappingSize(0),
+    count(0),
+    height(0),
+    width(0)
+{
+}
+
+LevelPack::~LevelPack()
+{
+    this->close();
+}
+
+bool LevelPack::is_pack(const unsigned char *data, size_t size) {
+    return size >= HEADER_SIZE && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool LevelPack::open(const unsigned char *_data, size_t _size) {
+    if (!is_pack(_data, _size) || read16(_data + 8) != VERSION) return false;
+    int _height = static_cast<int>(read16(_data + 10));
+    int _width = static_cast<int>(read16(_data + 12));
+    int _count = static_cast<int>(read32(_data + 16));
+    if (_height < 1 || _width < 1 || _height > MAX_SIZE || _width > MAX_SIZE || _count < 0) return false;
+    // The index must fit in the file and end at the end of the data
+    if ((_size - HEADER_SIZE) / 4 < static_cast<size_t>(_count) + 1) return false;
+    if (read32(_data + HEADER_SIZE + 4 * static_cast<size_t>(_count)) > _size) return false;
+
+    this->data = _data;
+    this->size = _size;
+    this->height = _height;
+    this->width = _width;
+    this->count = _count;
+    return true;
+}
+
+bool LevelPack::open(const string &path) {
+    this->close();
+#if defined(_WIN32)
+    // No mapping here, keep the whole file instead
+    ifstream file(path.c_str(), ios::binary | ios::ate);
+    if (!file) return false;
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    unsigned char *buffer = new unsigned char[fileSize];
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(buffer), static_cast<streamsize>(fileSize));
+    this->mapping = buffer;
+    this->mappingSize = fileSize;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size <= 0) {
+        ::close(file);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED) return false;
+    this->mapping = view;
+    this->mappingSize = static_cast<size_t>(info.st_size);
+#endif
+    if (!this->open(static_cast<const unsigned char *>(this->mapping), this->mappingSize)) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void LevelPack::close() {
+    if (this->mapping != nullptr) {
+#if defined(_WIN32)
+        delete [] static_cast<unsigned char *>(this->mapping);
+#else
+        munmap(this->mapping, this->mappingSize);
+#endif
+    }
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->data = nullptr;
+    this->size = 0;
+    this->count = 0;
+    this->height = 0;
+    this->width = 0;
+}
+
+int LevelPack::get_count() const {
+    return this->count;
+}
+
+int LevelPack::get_height() const {
+    return this->height;
+}
+
+int LevelPack::get_width() const {
+    return this->width;
+}
+
+bool LevelPack::load_level(int level, Board &board) const {
+    if (level < 1 || level > this->count) return false;
+    const unsigned char *index = this->data + HEADER_SIZE + 4 * static_cast<size_t>(level - 1);
+    size_t begin = read32(index);
+    size_t end = read32(index + 4);
+    // Levels start after the index
+    if (begin < HEADER_SIZE + 4 * (static_cast<size_t>(this->count) + 1) || begin > end || end > this->size) {
+        return false;
+    }
+
+    const unsigned char *token = this->data + begin;
+    const unsigned char *last = this->data + end;
+    const int blocks = this->height * this->width;
+    Board result{this->height, this->width};
+    int block = 0;
+    while (token != last && block < blocks) {
+        unsigned char value = *token++;
+        if (value & EMPTY_RUN) {
+            int run = (value & (EMPTY_RUN - 1)) + 1;
+            if (run > blocks - block || (last - token) < (run + 3) / 4) return false;
+            for (int i = 0; i < run; ++i, ++block) {
+                int orientation = (token[i / 4] >> (2 * (i % 4))) & 3;
+                result.set_block(block / this->width, block % this->width, BlockType::EMPTY, orientation);
+            }
+            token += (run + 3) / 4;
+        } else {
+            int type = value & 7;
+            if (type >= BlockType::EMPTY) return false;
+            result.set_block(block / this->width, block % this->width, static_cast<BlockType>(type), (value >> 3) & 3);
+            ++block;
+        }
+    }
+    if (block != blocks || token != last) return false;
+    board = result;
+    return true;
+}
+
+bool LevelPack::write(const string &path, const LevelSource &source) {
+    const int levels = source.get_count();
+    Board board;
+    int packHeight = Board::DEFAULT_SIZE;
+    int packWidth = Board::DEFAULT_SIZE;
+    if (levels > 0) {
+        if (!source.load_level(1, board)) return false;
+        packHeight = board.get_height();
+        packWidth = board.get_width();
+    }
+
+    vector<unsigned char> header(MAGIC, MAGIC + sizeof(MAGIC));
+    write16(header, VERSION);
+    write16(header, static_cast<uint32_t>(packHeight));
+    write16(header, static_cast<uint32_t>(packWidth));
+    write16(header, 0);
+    write32(header, static_cast<uint32_t>(levels));
+
+    vector<unsigned char> body;
+    vector<uint32_t> offsets;
+    const size_t dataStart = HEADER_SIZE + 4 * (static_cast<size_t>(levels) + 1);
+    for (int level = 1; level <= levels; ++level) {
+        if (!source.load_level(level, board)) return false;
+        if (board.get_height() != packHeight || board.get_width() != packWidth) return false;
+        if (dataStart + body.size() > UINT32_MAX) return false;
+        offsets.push_back(static_cast<uint32_t>(dataStart + body.size()));
+
+        const int blocks = packHeight * packWidth;
+        for (int block = 0; block < blocks; ) {
+            int y = block / packWidth;
+            int x = block % packWidth;
+            if (board.get_type(y, x) != BlockType::EMPTY) {
+                body.push_back(static_cast<unsigned char>(board.get_type(y, x) | (board.get_orientation(y, x) << 3)));
+                ++block;
+                continue;
+            }
+            int run = 0;
+            while (run < MAX_RUN && block + run < blocks
+                   && board.get_type((block + run) / packWidth, (block + run) % packWidth) == BlockType::EMPTY) {
+                ++run;
+            }
+            body.push_back(static_cast<unsigned char>(EMPTY_RUN | (run - 1)));
+            for (int i = 0; i < run; i += 4) {
+                unsigned char packed = 0;
+                for (int j = i; j < run && j < i + 4; ++j) {
+                    packed |= board.get_orientation((block + j) / packWidth, (block + j) % packWidth) << (2 * (j - i));
+                }
+                body.push_back(packed);
+            }
+            block += run;
+        }
+    }
+    if (dataStart + body.size() > UINT32_MAX) return false;
+    offsets.push_back(static_cast<uint32_t>(dataStart + body.size()));
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        write32(header, offsets[i]);
+    }
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool written = fwrite(header.data(), 1, header.size(), file) == header.size()
+                && fwrite(body.data(), 1, body.size(), file) == body.size();
+    return fclose(file) == 0 && written;
+}
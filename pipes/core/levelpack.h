@@ -0,0 +1,57 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "levelsource.h"
+
+// Compiled binary level pack. All levels share the board size in the header;
+// an offset index gives O(1) access to any level, which is only decoded when
+// loaded. Non-empty blocks take one byte (3-bit type, 2-bit orientation) and
+// runs of empty blocks take one byte plus their orientations packed 4 a byte.
+//
+//   header  "PIPEPACK", u16 version, u16 height, u16 width, u16 reserved, u32 count
+//   index   u32 offset of each level from the start of the file, plus the end
+//   levels  block tokens in row-major order
+//
+// All integers are little-endian; boards are 1 to 4096 blocks a side.
+class LevelPack : public LevelSource
+{
+ public:
+    static const int VERSION = 1;
+    static const std::size_t HEADER_SIZE = 20;
+
+    LevelPack();
+    ~LevelPack();
+
+    // Memory-map a pack file
+    bool open(const std::string &path);
+    // Use pack data owned by the caller
+    bool open(const unsigned char *_data, std::size_t _size);
+    void close();
+
+    int get_count() const;
+    int get_height() const;
+    int get_width() const;
+    bool load_level(int level, Board &board) const;
+
+    static bool is_pack(const unsigned char *data, std::size_t size);
+    // Write every level of `source` as a pack; they must all be the same size
+    static bool write(const std::string &path, const LevelSource &source);
+
+ private:
+    const unsigned char *data;
+    std::size_t size;
+    void *mapping;
+    std::size_t mappingSize;
+    int count;
+    int height;
+    int width;
+
+    LevelPack(const LevelPack &);
+    LevelPack &operator=(const LevelPack &);
+};
+
+#endif // LEVELPACK_H
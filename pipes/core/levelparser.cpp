@@ -0,0 +1,202 @@
+#include "levelparser.h"
+
+using namespace std;
+
+// Single pass tokenizer keeping track of the position for error messages
+class MapTokenizer
+{
+ public:
+    MapTokenizer(const char *_data, size_t _size):
+        data(_data),
+        end(_data + _size),
+        line(1),
+        column(1)
+    {
+    }
+
+    // Skip whitespace and commas, which only separate tuples
+    void skip() {
+        while (this->data != this->end) {
+            char c = *this->data;
+            if (c == '\n') {
+                break;
+            } else if (c == ' ' || c == '\t' || c == '\r' || c == ',') {
+                this->advance();
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool at_end() const { return this->data == this->end; }
+    char peek() const { return *this->data; }
+
+    void advance() {
+        if (*this->data == '\n') {
+            ++this->line;
+            this->column = 1;
+        } else {
+            ++this->column;
+        }
+        ++this->data;
+    }
+
+    bool expect(char c) {
+        if (this->at_end() || *this->data != c) return false;
+        this->advance();
+        return true;
+    }
+
+    bool number(int &value) {
+        if (this->at_end() || *this->data < '0' || *this->data > '9') return false;
+        value = 0;
+        while (!this->at_end() && *this->data >= '0' && *this->data <= '9') {
+            value = value * 10 + (*this->data - '0');
+            if (value > 1000) return false;
+            this->advance();
+        }
+        return true;
+    }
+
+    bool fail(ParseError *error, const string &message) const {
+        if (error != nullptr) {
+            error->line = this->line;
+            error->column = this->column;
+            error->message = message;
+        }
+        return false;
+    }
+
+ private:
+    const char *data;
+    const char *end;
+    int line;
+    int column;
+};
+
+LevelTable::LevelTable()
+{
+}
+
+int LevelTable::get_count() const {
+    return static_cast<int>(this->levels.size());
+}
+
+const Board &LevelTable::get_level(int level) const {
+    return this->levels[level - 1];
+}
+
+bool LevelTable::load_level(int level, Board &board) const {
+    if (level < 1 || level > this->get_count()) return false;
+    board = this->levels[level - 1];
+    return true;
+}
+
+void LevelTable::add_level(const Board &board) {
+    this->levels.push_back(board);
+}
+
+bool LevelTable::parse(const char *data, size_t size, ParseError *error) {
+    this->levels.clear();
+    MapTokenizer tokens{data, size};
+    vector<unsigned char> blocks;
+
+    while (true) {
+        // Levels are separated by blank space only
+        while (!tokens.at_end() && (tokens.peek() == ' ' || tokens.peek() == '\t'
+                                    || tokens.peek() == '\r' || tokens.peek() == '\n')) {
+            tokens.advance();
+        }
+        if (tokens.at_end()) break;
+        if (!tokens.expect('[')) {
+            this->levels.clear();
+            return tokens.fail(error, "expected '[' to start a level");
+        }
+
+        blocks.clear();
+        int width = 0;
+        int height = 0;
+        int rowLength = 0;
+        while (true) {
+            tokens.skip();
+            if (tokens.at_end()) {
+                this->levels.clear();
+                return tokens.fail(error, "level is not closed by ']'");
+            }
+            char c = tokens.peek();
+            if (c == '\n' || c == ']') {
+                // End of a board row
+                if (rowLength > 0) {
+                    if (width == 0) width = rowLength;
+                    if (rowLength != width) {
+                        this->levels.clear();
+                        return tokens.fail(error, "row has a different number of blocks than the first row");
+                    }
+                    ++height;
+                    rowLength = 0;
+                }
+                tokens.advance();
+                if (c == ']') break;
+                continue;
+            }
+
+            int type;
+            int orientation;
+            if (!tokens.expect('(')) {
+                this->levels.clear();
+                return tokens.fail(error, "expected '(' to start a block");
+            }
+            tokens.skip();
+            MapTokenizer start = tokens;
+            if (!tokens.number(type) || type > BlockType::EMPTY) {
+                this->levels.clear();
+                return start.fail(error, "expected a block type from 0 to 4");
+            }
+            tokens.skip();
+            start = tokens;
+            if (!tokens.number(orientation) || orientation > 3) {
+                this->levels.clear();
+                return start.fail(error, "expected an orientation from 0 to 3");
+            }
+            tokens.skip();
+            if (!tokens.expect(')')) {
+                this->levels.clear();
+                return tokens.fail(error, "expected ')' to end a block");
+            }
+            blocks.push_back(static_cast<unsigned char>(type));
+            blocks.push_back(static_cast<unsigned char>(orientation));
+            ++rowLength;
+        }
+
+        if (height == 0) {
+            this->levels.clear();
+            return tokens.fail(error, "level has no blocks");
+        }
+        Board board{height, width};
+        for (int index = 0; index < height * width; ++index) {
+            board.set_block(index / width, index % width,
+                            static_cast<BlockType>(blocks[2 * index]), blocks[2 * index + 1]);
+        }
+        this->levels.push_back(board);
+    }
+
+    return true;
+}
+
+string formatLevel(const Board &board) {
+    string text = "[\n";
+    for (int y = 0; y < board.get_height(); ++y) {
+        text += "   ";
+        for (int x = 0; x < board.get_width(); ++x) {
+            text += " (";
+            text += static_cast<char>('0' + board.get_type(y, x));
+            text += ", ";
+            text += static_cast<char>('0' + board.get_orientation(y, x));
+            text += ")";
+            if (y + 1 < board.get_height() || x + 1 < board.get_width()) text += ",";
+        }
+        text += "\n";
+    }
+    text += "]\n";
+    return text;
+}
@@ -0,0 +1,40 @@
+#ifndef LEVELPARSER_H
+#define LEVELPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "levelsource.h"
+
+struct ParseError {
+    int line;
+    int column;
+    std::string message;
+};
+
+// Levels of a maps.txt file, numbered from 1. Every level is a bracketed
+// list of (type, orientation) tuples with one board row per line.
+class LevelTable : public LevelSource
+{
+ public:
+    LevelTable();
+
+    // Replace the table with the levels in `data`; on failure the table is
+    // left empty and `error` tells where parsing stopped
+    bool parse(const char *data, std::size_t size, ParseError *error = nullptr);
+
+    int get_count() const;
+    const Board &get_level(int level) const;
+    bool load_level(int level, Board &board) const;
+    void add_level(const Board &board);
+
+ private:
+    std::vector<Board> levels;
+};
+
+// One level in the maps.txt syntax
+std::string formatLevel(const Board &board);
+
+#endif // LEVELPARSER_H
@@ -0,0 +1,37 @@
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "levelsource.h"
+#include "levelpack.h"
+#include "levelparser.h"
+
+using namespace std;
+
+LevelSource::~LevelSource()
+{
+}
+
+unique_ptr<LevelSource> openLevels(const string &path, ParseError *error) {
+    // Packs are mapped, text files are parsed up front
+    unique_ptr<LevelPack> pack(new LevelPack());
+    if (pack->open(path)) {
+        return unique_ptr<LevelSource>(pack.release());
+    }
+
+    ifstream file(path.c_str(), ios::binary);
+    if (!file) {
+        if (error != nullptr) *error = {0, 0, "can not open " + path};
+        return nullptr;
+    }
+    vector<char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (LevelPack::is_pack(reinterpret_cast<const unsigned char *>(data.data()), data.size())) {
+        if (error != nullptr) *error = {0, 0, "unsupported or damaged level pack"};
+        return nullptr;
+    }
+    unique_ptr<LevelTable> table(new LevelTable());
+    if (!table->parse(data.data(), data.size(), error)) {
+        return nullptr;
+    }
+    return unique_ptr<LevelSource>(table.release());
+}
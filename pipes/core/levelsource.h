@@ -0,0 +1,23 @@
+#ifndef LEVELSOURCE_H
+#define LEVELSOURCE_H
+
+#include <memory>
+#include <string>
+
+#include "board.h"
+
+struct ParseError;
+
+// A numbered collection of levels, counted from 1
+class LevelSource
+{
+ public:
+    virtual ~LevelSource();
+    virtual int get_count() const = 0;
+    virtual bool load_level(int level, Board &board) const = 0;
+};
+
+// Open a level file in either the maps.txt syntax or the binary pack format
+std::unique_ptr<LevelSource> openLevels(const std::string &path, ParseError *error = nullptr);
+
+#endif // LEVELSOURCE_H
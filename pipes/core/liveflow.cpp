@@ -0,0 +1,167 @@
+#include <cstddef>
+
+#include "liveflow.h"
+
+using namespace std;
+
+LiveFlow::LiveFlow(const Board &_board):
+    board(_board),
+    height(_board.get_height()),
+    width(_board.get_width()),
+    leakCount(0)
+{
+    this->reset();
+}
+
+int LiveFlow::neighbour(int index, int direction) const {
+    int y = index / this->width + deltaY(direction);
+    int x = index % this->width + deltaX(direction);
+    if (!this->board.contains(y, x)) return -1;
+    return y * this->width + x;
+}
+
+bool LiveFlow::matched(int index, int direction) const {
+    int next = this->neighbour(index, direction);
+    if (next < 0) {
+        // The inlet and the outlet are the only openings in the border
+        return (index == 0 && direction == LEFT)
+            || (index == this->height * this->width - 1 && direction == RIGHT);
+    }
+    const unsigned char *cells = this->board.get_cells();
+    return (Board::cell_direction(cells[index]) & direction)
+        && (Board::cell_direction(cells[next]) & oppositeDirection(direction));
+}
+
+void LiveFlow::wet(int index, int parent) {
+    this->state[index] = static_cast<unsigned char>(WET | parent);
+    this->updateLeaks(index);
+    this->queue.push_back(index);
+    this->dirty.push_back(index);
+}
+
+void LiveFlow::dry(int index) {
+    this->state[index] = 0;
+    this->updateLeaks(index);
+    this->dirty.push_back(index);
+}
+
+void LiveFlow::updateLeaks(int index) {
+    int leaks = 0;
+    if (this->state[index] & WET) {
+        int direction = Board::cell_direction(this->board.get_cells()[index]);
+        for (int end = LEFT; end <= DOWN; end <<= 1) {
+            if ((direction & end) && !this->matched(index, end)) leaks |= end;
+        }
+    }
+    for (int end = LEFT; end <= DOWN; end <<= 1) {
+        if (this->leaks[index] & end) --this->leakCount;
+        if (leaks & end) ++this->leakCount;
+    }
+    this->leaks[index] = static_cast<unsigned char>(leaks);
+}
+
+// Spread the water from the queued blocks, starting at `begin`
+void LiveFlow::flood(size_t begin) {
+    for (size_t i = begin; i < this->queue.size(); ++i) {
+        int index = this->queue[i];
+        for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+            int next = this->neighbour(index, direction);
+            if (next < 0 || (this->state[next] & WET) || !this->matched(index, direction)) continue;
+            this->wet(next, oppositeDirection(direction));
+        }
+    }
+    this->queue.clear();
+}
+
+void LiveFlow::reset() {
+    this->height = this->board.get_height();
+    this->width = this->board.get_width();
+    const size_t blocks = static_cast<size_t>(this->height) * static_cast<size_t>(this->width);
+    this->state.assign(blocks, 0);
+    this->leaks.assign(blocks, 0);
+    this->leakCount = 0;
+    this->queue.clear();
+    this->dirty.clear();
+    for (size_t index = 0; index < blocks; ++index) {
+        this->dirty.push_back(static_cast<int>(index));
+    }
+    if (Board::cell_direction(this->board.get_cells()[0]) & LEFT) {
+        this->wet(0, 0);
+        this->flood(0);
+    }
+}
+
+void LiveFlow::changed(int y, int x) {
+    const int index = y * this->width + x;
+
+    if (this->state[index] & WET) {
+        // Dry the subtree fed through this block
+        this->queue.push_back(index);
+        for (size_t i = 0; i < this->queue.size(); ++i) {
+            int current = this->queue[i];
+            for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+                int next = this->neighbour(current, direction);
+                if (next < 0 || !(this->state[next] & WET)) continue;
+                if ((this->state[next] & PARENT) == oppositeDirection(direction)) {
+                    this->queue.push_back(next);
+                }
+            }
+        }
+        vector<int> dried;
+        dried.swap(this->queue);
+        for (size_t i = 0; i < dried.size(); ++i) {
+            this->dry(dried[i]);
+        }
+
+        // Refill it from whatever wet blocks still reach into it
+        if (index == 0 && (Board::cell_direction(this->board.get_cells()[0]) & LEFT)) {
+            this->wet(0, 0);
+            this->flood(0);
+        }
+        for (size_t i = 0; i < dried.size(); ++i) {
+            int current = dried[i];
+            if (this->state[current] & WET) continue;
+            for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+                int next = this->neighbour(current, direction);
+                if (next < 0 || !(this->state[next] & WET) || !this->matched(current, direction)) continue;
+                this->wet(current, direction);
+                this->flood(0);
+                break;
+            }
+        }
+    } else {
+        if (index == 0 && (Board::cell_direction(this->board.get_cells()[0]) & LEFT)) {
+            this->wet(0, 0);
+        }
+        for (int direction = LEFT; direction <= DOWN && !(this->state[index] & WET); direction <<= 1) {
+            int next = this->neighbour(index, direction);
+            if (next < 0 || !(this->state[next] & WET) || !this->matched(index, direction)) continue;
+            this->wet(index, direction);
+        }
+        this->flood(0);
+    }
+
+    // The pipe ends facing this block may have (un)matched
+    this->updateLeaks(index);
+    for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+        int next = this->neighbour(index, direction);
+        if (next >= 0) this->updateLeaks(next);
+    }
+}
+
+BFSStatus LiveFlow::get_status() const {
+    // Cannot flow from the inlet
+    if (!(this->state[0] & WET)) return BFSStatus::LEAKAGE;
+    if (this->leakCount > 0) return BFSStatus::LEAKAGE;
+    const int last = this->height * this->width - 1;
+    if ((this->state[last] & WET) && (Board::cell_direction(this->board.get_cells()[last]) & RIGHT)) {
+        return BFSStatus::CONNECTED;
+    }
+    return BFSStatus::STUCK;
+}
+
+vector<int> LiveFlow::take_changed() {
+    vector<int> changed;
+    changed.swap(this->dirty);
+    return changed;
+}
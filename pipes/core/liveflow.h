@@ -0,0 +1,65 @@
+#ifndef LIVEFLOW_H
+#define LIVEFLOW_H
+
+#include <vector>
+
+#include "board.h"
+#include "evaluator.h"
+
+// Keeps the wet blocks and open pipe ends of a board up to date while single
+// blocks change. Wet blocks form a tree rooted at the inlet; changing a block
+// only re-floods the subtree hanging off it and whatever its new pipe ends
+// reach, so a click costs no more than the region it can affect.
+class LiveFlow
+{
+ public:
+    explicit LiveFlow(const Board &_board);
+
+    // Recompute everything, e.g. after the whole board changed or was resized
+    void reset();
+    // Call after the block at (y, x) was rotated or replaced
+    void changed(int y, int x);
+
+    BFSStatus get_status() const;
+    bool is_wet(int y, int x) const;
+    // Pipe ends of a wet block that do not meet a matching end
+    int get_leaks(int y, int x) const;
+    int get_leak_count() const;
+    // Blocks whose wetness may have changed since the last call
+    std::vector<int> take_changed();
+
+ private:
+    static const unsigned char WET = 1 << 4;
+    static const unsigned char PARENT = WET - 1;
+
+    const Board &board;
+    int height;
+    int width;
+    // WET flag plus the direction towards the parent block
+    std::vector<unsigned char> state;
+    std::vector<unsigned char> leaks;
+    int leakCount;
+    std::vector<int> queue;
+    std::vector<int> dirty;
+
+    int neighbour(int index, int direction) const;
+    bool matched(int index, int direction) const;
+    void wet(int index, int parent);
+    void dry(int index);
+    void updateLeaks(int index);
+    void flood(size_t begin);
+};
+
+inline bool LiveFlow::is_wet(int y, int x) const {
+    return this->state[y * this->width + x] & WET;
+}
+
+inline int LiveFlow::get_leaks(int y, int x) const {
+    return this->leaks[y * this->width + x];
+}
+
+inline int LiveFlow::get_leak_count() const {
+    return this->leakCount;
+}
+
+#endif // LIVEFLOW_H
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "parallelevaluator.h"
+
+using namespace std;
+
+typedef atomic<uint32_t> Parent;
+
+// Path-halving find; safe to run concurrently since parents only ever move
+// towards the root
+static uint32_t find(Parent *parent, uint32_t index) {
+    uint32_t next = parent[index].load(memory_order_relaxed);
+    while (next != index) {
+        uint32_t grand = parent[next].load(memory_order_relaxed);
+        parent[index].store(grand, memory_order_relaxed);
+        index = next;
+        next = grand;
+    }
+    return index;
+}
+
+// Only used while no other thread touches the same components
+static void unite(Parent *parent, uint32_t a, uint32_t b) {
+    a = find(parent, a);
+    b = find(parent, b);
+    if (a == b) return;
+    if (a < b) {
+        parent[b].store(a, memory_order_relaxed);
+    } else {
+        parent[a].store(b, memory_order_relaxed);
+    }
+}
+
+static void runBands(int height, int threads, void (*work)(void *, int, int), void *context) {
+    vector<thread> workers;
+    int rows = (height + threads - 1) / threads;
+    for (int begin = 0; begin < height; begin += rows) {
+        workers.emplace_back(work, context, begin, min(height, begin + rows));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
+
+struct BandContext {
+    const unsigned char *cells;
+    Parent *parent;
+    int height;
+    int width;
+    int direction[32];
+    atomic<bool> leaked;
+    uint32_t inletRoot;
+};
+
+static void joinBand(void *context, int begin, int end) {
+    BandContext &band = *static_cast<BandContext *>(context);
+    const uint32_t width = static_cast<uint32_t>(band.width);
+    for (uint32_t index = begin * width; index < end * width; ++index) {
+        band.parent[index].store(index, memory_order_relaxed);
+    }
+    for (int y = begin; y < end; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t index = y * width + x;
+            int direction = band.direction[band.cells[index]];
+            if ((direction & RIGHT) && x + 1 < width && (band.direction[band.cells[index + 1]] & LEFT)) {
+                unite(band.parent, index, index + 1);
+            }
+            if ((direction & DOWN) && y + 1 < end && (band.direction[band.cells[index + width]] & UP)) {
+                unite(band.parent, index, index + width);
+            }
+        }
+    }
+}
+
+static void checkBand(void *context, int begin, int end) {
+    BandContext &band = *static_cast<BandContext *>(context);
+    const uint32_t width = static_cast<uint32_t>(band.width);
+    const uint32_t last = static_cast<uint32_t>(band.height) * width - 1;
+    for (int y = begin; y < end; ++y) {
+        if (band.leaked.load(memory_order_relaxed)) return;
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t index = y * width + x;
+            int direction = band.direction[band.cells[index]];
+            if (direction == 0) continue;
+            // Pipe ends without a matching end across, other than the inlet and outlet
+            bool leak = false;
+            if (direction & LEFT) {
+                leak |= x > 0 ? !(band.direction[band.cells[index - 1]] & RIGHT) : index != 0;
+            }
+            if (direction & RIGHT) {
+                leak |= x + 1 < width ? !(band.direction[band.cells[index + 1]] & LEFT) : index != last;
+            }
+            if (direction & UP) {
+                leak |= y == 0 || !(band.direction[band.cells[index - width]] & DOWN);
+            }
+            if (direction & DOWN) {
+                leak |= y + 1 == band.height || !(band.direction[band.cells[index + width]] & UP);
+            }
+            if (leak && find(band.parent, index) == band.inletRoot) {
+                band.leaked.store(true, memory_order_relaxed);
+                return;
+            }
+        }
+    }
+}
+
+BFSResult evaluateParallel(const Board &board, int threads) {
+    const int height = board.get_height();
+    const int width = board.get_width();
+    const uint32_t blocks = static_cast<uint32_t>(height) * static_cast<uint32_t>(width);
+    const unsigned char *cells = board.get_cells();
+
+    // Cannot flow from the inlet
+    if ((Board::cell_direction(cells[0]) & LEFT) == 0) {
+        return {BFSStatus::LEAKAGE, 0};
+    }
+
+    if (threads <= 0) {
+        threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    }
+    threads = min(threads, height);
+
+    unique_ptr<Parent[]> parent(new Parent[blocks]);
+    BandContext band;
+    band.cells = cells;
+    band.parent = parent.get();
+    band.height = height;
+    band.width = width;
+    for (int cell = 0; cell < 32; ++cell) {
+        band.direction[cell] = Board::cell_direction(static_cast<unsigned char>(cell));
+    }
+    band.leaked.store(false);
+
+    runBands(height, threads, joinBand, &band);
+
+    // Stitch the bands together along their borders
+    int rows = (height + threads - 1) / threads;
+    for (int y = rows; y < height; y += rows) {
+        for (int x = 0; x < width; ++x) {
+            uint32_t index = static_cast<uint32_t>(y) * width + x;
+            if ((band.direction[cells[index - width]] & DOWN) && (band.direction[cells[index]] & UP)) {
+                unite(band.parent, index - width, index);
+            }
+        }
+    }
+
+    band.inletRoot = find(band.parent, 0);
+    runBands(height, threads, checkBand, &band);
+
+    BFSStatus status = BFSStatus::STUCK;
+    if (band.leaked.load()) {
+        status = BFSStatus::LEAKAGE;
+    } else if ((band.direction[cells[blocks - 1]] & RIGHT) && find(band.parent, blocks - 1) == band.inletRoot) {
+        status = BFSStatus::CONNECTED;
+    }
+    return {status, 0};
+}
@@ -0,0 +1,16 @@
+#ifndef PARALLELEVALUATOR_H
+#define PARALLELEVALUATOR_H
+
+#include "board.h"
+#include "evaluator.h"
+
+// Boards at least this large are evaluated in parallel by evaluate()
+static const int PARALLEL_EVALUATION_BLOCKS = 256 * 256;
+
+// Same outcome as evaluate() for boards of any size, using `threads` threads
+// (all cores when 0). The board is cut into horizontal bands that are joined
+// by union-find independently, then stitched along the band borders. Layers
+// are not tracked, so `cycles` is always 0.
+BFSResult evaluateParallel(const Board &board, int threads = 0);
+
+#endif // PARALLELEVALUATOR_H
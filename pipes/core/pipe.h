@@ -0,0 +1,93 @@
+#ifndef PIPE_H
+#define PIPE_H
+
+// Bit mask info
+static const int LEFT   = 1 << 0;
+static const int UP     = 1 << 1;
+static const int RIGHT  = 1 << 2;
+static const int DOWN   = 1 << 3;
+
+// Type info
+enum BlockType {
+    TJUNCTION, TURN, STRAIGHT, CROSS, EMPTY
+};
+
+struct BlockData {
+    BlockType type;
+    int orientation;
+};
+
+// Pipe geometry is fixed, so it is worked out by the compiler into the tables
+// below and every lookup is a single load
+
+// Rotate directions clockwise by 90 degrees, `turns` times
+constexpr int rotateEnds(int direction, int turns) {
+    return ((direction << turns) | (direction >> (4 - turns))) & 15;
+}
+
+constexpr int baseEnds(int type) {
+    return type == TJUNCTION ? (UP | RIGHT | DOWN)
+         : type == TURN ? (UP | RIGHT)
+         : type == STRAIGHT ? (LEFT | RIGHT)
+         : type == CROSS ? (LEFT | UP | RIGHT | DOWN)
+         : 0;
+}
+
+// Flow directions of every encoded cell, type | orientation << 3 as Board stores it
+constexpr unsigned char CELL_DIRECTIONS[32] = {
+    rotateEnds(baseEnds(0), 0), rotateEnds(baseEnds(1), 0), rotateEnds(baseEnds(2), 0), rotateEnds(baseEnds(3), 0),
+    0, 0, 0, 0,
+    rotateEnds(baseEnds(0), 1), rotateEnds(baseEnds(1), 1), rotateEnds(baseEnds(2), 1), rotateEnds(baseEnds(3), 1),
+    0, 0, 0, 0,
+    rotateEnds(baseEnds(0), 2), rotateEnds(baseEnds(1), 2), rotateEnds(baseEnds(2), 2), rotateEnds(baseEnds(3), 2),
+    0, 0, 0, 0,
+    rotateEnds(baseEnds(0), 3), rotateEnds(baseEnds(1), 3), rotateEnds(baseEnds(2), 3), rotateEnds(baseEnds(3), 3),
+    0, 0, 0, 0,
+};
+
+constexpr int deltaYOf(int direction) {
+    return (direction & (LEFT | RIGHT)) ? 0 : (direction & UP) ? -1 : (direction & DOWN) ? 1 : 0;
+}
+
+constexpr int deltaXOf(int direction) {
+    return (direction & (UP | DOWN)) ? 0 : (direction & LEFT) ? -1 : (direction & RIGHT) ? 1 : 0;
+}
+
+// Indexed by any direction mask
+constexpr signed char DELTA_Y[16] = {
+    deltaYOf(0), deltaYOf(1), deltaYOf(2), deltaYOf(3), deltaYOf(4), deltaYOf(5), deltaYOf(6), deltaYOf(7),
+    deltaYOf(8), deltaYOf(9), deltaYOf(10), deltaYOf(11), deltaYOf(12), deltaYOf(13), deltaYOf(14), deltaYOf(15),
+};
+
+constexpr signed char DELTA_X[16] = {
+    deltaXOf(0), deltaXOf(1), deltaXOf(2), deltaXOf(3), deltaXOf(4), deltaXOf(5), deltaXOf(6), deltaXOf(7),
+    deltaXOf(8), deltaXOf(9), deltaXOf(10), deltaXOf(11), deltaXOf(12), deltaXOf(13), deltaXOf(14), deltaXOf(15),
+};
+
+static_assert(CELL_DIRECTIONS[TJUNCTION | 1 << 3] == (LEFT | RIGHT | DOWN), "T-junctions turn clockwise");
+static_assert(CELL_DIRECTIONS[TURN | 3 << 3] == (LEFT | UP), "turns turn clockwise");
+static_assert(DELTA_Y[UP] == -1 && DELTA_X[RIGHT] == 1, "rows grow downwards");
+
+// Flow directions of a block type at a given orientation
+constexpr int pipeDirection(BlockType type, int orientation) {
+    return CELL_DIRECTIONS[(type & 7) | (orientation & 3) << 3];
+}
+
+// Rotate directions clockwise by 90 degrees
+constexpr int rotateDirection(int direction) {
+    return rotateEnds(direction, 1);
+}
+
+constexpr int oppositeDirection(int direction) {
+    return rotateEnds(direction, 2);
+}
+
+constexpr int deltaY(int direction) {
+    return DELTA_Y[direction & 15];
+}
+
+constexpr int deltaX(int direction) {
+    return DELTA_X[direction & 15];
+}
+
+#endif // PIPE_H
@@ -0,0 +1,37 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// splitmix64: tiny, fast and gives the same sequence on every platform, so a
+// seed always reproduces the same levels and spawns
+class Random
+{
+ public:
+    explicit Random(uint64_t seed = 0): state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (this->state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound)
+    int next_int(int bound) {
+        return static_cast<int>((this->next() >> 32) * static_cast<uint64_t>(bound) >> 32);
+    }
+
+    uint64_t get_state() const { return this->state; }
+
+    // Independent seed for the index-th item generated from `seed`
+    static uint64_t derive(uint64_t seed, uint64_t index) {
+        Random random{seed ^ (index * 0xD1B54A32D192ED03ULL)};
+        return random.next();
+    }
+
+ private:
+    uint64_t state;
+};
+
+#endif // RANDOM_H
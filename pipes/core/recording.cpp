@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "recording.h"
+
+using namespace std;
+
+const unsigned char Recording::VERSION;
+const int Recording::SPAWNS;
+
+static const char MAGIC[7] = {'P', 'I', 'P', 'E', 'R', 'E', 'C'};
+static const int MAX_SIZE = 4096;
+
+static void writeVarint(vector<unsigned char> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// Advances `position`, false on a truncated or overlong number
+static bool readVarint(const unsigned char *data, size_t size, size_t &position, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (position >= size) return false;
+        unsigned char byte = data[position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+Recording::Recording():
+    seed(0),
+    level(0),
+    flags(0),
+    eventCount(0)
+{
+}
+
+Recording::Recording(const Board &_start, uint64_t _seed, int _level, int _flags):
+    start(_start),
+    seed(_seed),
+    level(_level),
+    flags(_flags),
+    eventCount(0)
+{
+}
+
+void Recording::add_event(int kind, int value, uint32_t delay) {
+    writeVarint(this->events, static_cast<uint64_t>(value) << 2 | static_cast<uint64_t>(kind));
+    writeVarint(this->events, delay);
+    ++this->eventCount;
+}
+
+void Recording::add_rotation(int y, int x, uint32_t delay) {
+    this->add_event(RecordedEvent::ROTATE, y * this->start.get_width() + x, delay);
+}
+
+void Recording::add_swipe(SwipeDirection direction, uint32_t delay) {
+    this->add_event(RecordedEvent::SWIPE, direction, delay);
+}
+
+void Recording::add_undo(uint32_t delay) {
+    this->add_event(RecordedEvent::UNDO, 0, delay);
+}
+
+void Recording::add_redo(uint32_t delay) {
+    this->add_event(RecordedEvent::REDO, 0, delay);
+}
+
+const Board &Recording::get_start() const {
+    return this->start;
+}
+
+uint64_t Recording::get_seed() const {
+    return this->seed;
+}
+
+int Recording::get_level() const {
+    return this->level;
+}
+
+int Recording::get_flags() const {
+    return this->flags;
+}
+
+int Recording::get_event_count() const {
+    return this->eventCount;
+}
+
+const vector<unsigned char> &Recording::get_events() const {
+    return this->events;
+}
+
+string Recording::serialize() const {
+    vector<unsigned char> header(MAGIC, MAGIC + sizeof(MAGIC));
+    header.push_back(VERSION);
+    writeVarint(header, this->seed);
+    writeVarint(header, static_cast<uint32_t>(this->level));
+    writeVarint(header, static_cast<uint32_t>(this->flags));
+    writeVarint(header, static_cast<uint32_t>(this->start.get_height()));
+    writeVarint(header, static_cast<uint32_t>(this->start.get_width()));
+    const unsigned char *cells = this->start.get_cells();
+    header.insert(header.end(), cells, cells + this->start.get_height() * this->start.get_width());
+
+    string data(header.begin(), header.end());
+    data.append(this->events.begin(), this->events.end());
+    return data;
+}
+
+bool Recording::parse(const char *text, size_t size) {
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(text);
+    if (size < sizeof(MAGIC) + 1 || memcmp(data, MAGIC, sizeof(MAGIC)) != 0
+            || data[sizeof(MAGIC)] < 1 || data[sizeof(MAGIC)] > VERSION) {
+        return false;
+    }
+
+    size_t position = sizeof(MAGIC) + 1;
+    uint64_t _seed, _level, _flags, height, width;
+    if (!readVarint(data, size, position, _seed) || !readVarint(data, size, position, _level)
+            || !readVarint(data, size, position, _flags) || !readVarint(data, size, position, height)
+            || !readVarint(data, size, position, width)) {
+        return false;
+    }
+    if (height < 1 || width < 1 || height > MAX_SIZE || width > MAX_SIZE || size - position < height * width) {
+        return false;
+    }
+
+    Board _start{static_cast<int>(height), static_cast<int>(width)};
+    for (int y = 0; y < _start.get_height(); ++y) {
+        for (int x = 0; x < _start.get_width(); ++x) {
+            unsigned char cell = data[position++];
+            if ((cell & 7) > BlockType::EMPTY || (cell >> 5) != 0) return false;
+            _start.set_cell(y, x, cell);
+        }
+    }
+
+    // Check every event once so replaying never has to
+    int count = 0;
+    size_t eventsStart = position;
+    while (position < size) {
+        uint64_t event, delay;
+        if (!readVarint(data, size, position, event) || !readVarint(data, size, position, delay)) return false;
+        uint64_t value = event >> 2;
+        switch (event & 3) {
+        case RecordedEvent::ROTATE:
+            if (value >= height * width) return false;
+            break;
+        case RecordedEvent::SWIPE:
+            if (value > SWIPE_DOWN) return false;
+            break;
+        default:
+            if (value != 0) return false;
+        }
+        if (delay > UINT32_MAX) return false;
+        ++count;
+    }
+
+    this->start = _start;
+    this->seed = _seed;
+    this->level = static_cast<int>(_level);
+    this->flags = static_cast<int>(_flags);
+    this->eventCount = count;
+    this->events.assign(data + eventsStart, data + size);
+    return true;
+}
+
+bool Recording::save(const string &path) const {
+    string data = this->serialize();
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && written;
+}
+
+bool Recording::load(const string &path) {
+    ifstream file(path.c_str(), ios::binary);
+    if (!file) return false;
+    vector<char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    return this->parse(data.data(), data.size());
+}
+
+Replayer::Replayer(const Recording &_recording):
+    recording(_recording),
+    board(_recording.get_start()),
+    random(_recording.get_seed()),
+    position(0),
+    time(0)
+{
+}
+
+void Replayer::reset() {
+    this->board = this->recording.get_start();
+    this->random = Random{this->recording.get_seed()};
+    this->history.clear();
+    this->position = 0;
+    this->time = 0;
+}
+
+bool Replayer::step(RecordedEvent *event) {
+    const vector<unsigned char> &events = this->recording.get_events();
+    if (this->position >= events.size()) return false;
+
+    // parse() checked the stream, so the numbers are known to be complete
+    uint64_t code, delay;
+    readVarint(events.data(), events.size(), this->position, code);
+    readVarint(events.data(), events.size(), this->position, delay);
+    int value = static_cast<int>(code >> 2);
+    this->time += delay;
+
+    switch (code & 3) {
+    case RecordedEvent::ROTATE: {
+        int y = value / this->board.get_width();
+        int x = value % this->board.get_width();
+        // Empty blocks ignore clicks, as in the game
+        if (this->board.get_type(y, x) != BlockType::EMPTY) {
+            this->board.rotate(y, x);
+            this->history.add_rotation(y, x);
+        }
+        break;
+    }
+    case RecordedEvent::SWIPE:
+        this->history.add_snapshot(this->board);
+        swipe(this->board, static_cast<SwipeDirection>(value));
+        if (this->recording.get_flags() & Recording::SPAWNS) addRandomPipe(this->board, this->random);
+        break;
+    case RecordedEvent::UNDO:
+        this->history.undo(this->board);
+        break;
+    case RecordedEvent::REDO:
+        this->history.redo(this->board);
+    }
+
+    if (event != nullptr) {
+        event->kind = static_cast<RecordedEvent::Kind>(code & 3);
+        event->value = value;
+        event->delay = static_cast<uint32_t>(delay);
+    }
+    return true;
+}
+
+int Replayer::run() {
+    int count = 0;
+    while (this->step()) ++count;
+    return count;
+}
+
+const Board &Replayer::get_board() const {
+    return this->board;
+}
+
+uint64_t Replayer::get_time() const {
+    return this->time;
+}
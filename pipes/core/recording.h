@@ -0,0 +1,93 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "history.h"
+#include "random.h"
+#include "swipe.h"
+
+struct RecordedEvent {
+    enum Kind {ROTATE = 0, SWIPE = 1, UNDO = 2, REDO = 3};
+
+    Kind kind;
+    // Cell y * width + x for a rotation, SwipeDirection for a swipe, 0 otherwise
+    int value;
+    // Milliseconds since the previous event
+    uint32_t delay;
+};
+
+// A played game: the start position, the state of the spawn generator at that
+// point and every input in order. Stored as
+//   "PIPEREC" version
+//   varint seed, level, flags (1: pipes spawn after swipes), height, width
+//   height * width encoded cells
+//   per event: varint (value << 2 | kind), varint delay
+// so a rotation usually costs three bytes. Version 1 has no undo or redo.
+class Recording
+{
+ public:
+    static const unsigned char VERSION = 2;
+    static const int SPAWNS = 1;
+
+    Recording();
+    Recording(const Board &_start, uint64_t _seed, int _level, int _flags);
+
+    void add_rotation(int y, int x, uint32_t delay);
+    void add_swipe(SwipeDirection direction, uint32_t delay);
+    void add_undo(uint32_t delay);
+    void add_redo(uint32_t delay);
+
+    const Board &get_start() const;
+    uint64_t get_seed() const;
+    int get_level() const;
+    int get_flags() const;
+    int get_event_count() const;
+    const std::vector<unsigned char> &get_events() const;
+
+    std::string serialize() const;
+    bool parse(const char *data, std::size_t size);
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+ private:
+    Board start;
+    uint64_t seed;
+    int level;
+    int flags;
+    int eventCount;
+    std::vector<unsigned char> events;
+
+    void add_event(int kind, int value, uint32_t delay);
+};
+
+// Plays a recording back on its own board, without any window
+class Replayer
+{
+ public:
+    explicit Replayer(const Recording &_recording);
+
+    void reset();
+    // Applies the next event, false at the end of the recording
+    bool step(RecordedEvent *event = nullptr);
+    // Applies every remaining event and returns how many there were
+    int run();
+
+    const Board &get_board() const;
+    // Milliseconds of play up to the current event
+    uint64_t get_time() const;
+
+ private:
+    const Recording &recording;
+    Board board;
+    Random random;
+    History history;
+    std::size_t position;
+    uint64_t time;
+};
+
+#endif // RECORDING_H
@@ -0,0 +1,286 @@
+#include <chrono>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "recordstore.h"
+#include "trace.h"
+
+using namespace std;
+
+const uint32_t RecordStore::VERSION;
+const int RecordStore::PAGE_LEVELS;
+const int RecordStore::BATCH_DELAY;
+
+static const char MAGIC[8] = {'P', 'I', 'P', 'E', 'S', 'C', 'O', 'R'};
+static const size_t HEADER_SIZE = 16;
+static const size_t PAGE_BYTES = RecordStore::PAGE_LEVELS * 4;
+
+static uint32_t read32(const unsigned char *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static void write32(vector<unsigned char> &out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+// Writes what is buffered for the file through to the disk
+static bool syncFile(FILE *file) {
+#if defined(_WIN32)
+    return fflush(file) == 0 && _commit(_fileno(file)) == 0;
+#else
+    return fflush(file) == 0 && fsync(fileno(file)) == 0;
+#endif
+}
+
+// Replaces the file at path, so that a crash leaves either the old or the new one
+static bool replaceFile(const string &temporary, const string &path) {
+#if defined(_WIN32)
+    return MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+}
+
+// A rename lasts only once the directory holding the file is on the disk.
+// MOVEFILE_WRITE_THROUGH already waits for that on Windows.
+static bool syncDirectory(const string &path) {
+#if defined(_WIN32)
+    (void)path;
+    return true;
+#else
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int descriptor = ::open(directory.c_str(), O_RDONLY);
+    if (descriptor < 0) return false;
+    bool synced = fsync(descriptor) == 0;
+    close(descriptor);
+    return synced;
+#endif
+}
+
+RecordStore::RecordStore(const string &_path):
+    path(_path),
+    valid(true),
+    file(nullptr),
+    pending(false),
+    flushing(0),
+    stopping(false),
+    failed(false),
+    requested(0),
+    completed(0)
+{
+    this->valid = this->open();
+    this->writer = thread(&RecordStore::work, this);
+}
+
+RecordStore::~RecordStore()
+{
+    {
+        lock_guard<mutex> lock(this->guard);
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+    this->writer.join();
+    if (this->file != nullptr) fclose(this->file);
+}
+
+bool RecordStore::is_valid() const {
+    return this->valid;
+}
+
+// Reads the page index only, a missing file is an empty store
+bool RecordStore::open() {
+    PIPES_TRACE_SCOPE("RecordStore::open");
+    this->file = fopen(this->path.c_str(), "rb");
+    if (this->file == nullptr) return true;
+
+    unsigned char header[HEADER_SIZE];
+    if (fread(header, 1, HEADER_SIZE, this->file) != HEADER_SIZE || memcmp(header, MAGIC, sizeof(MAGIC)) != 0
+            || read32(header + 8) != VERSION) {
+        return false;
+    }
+    uint32_t count = read32(header + 12);
+    if (fseek(this->file, 0, SEEK_END) != 0) return false;
+    long size = ftell(this->file);
+    if (size < 0 || (static_cast<size_t>(size) - HEADER_SIZE) / 8 < count) return false;
+
+    vector<unsigned char> index(static_cast<size_t>(count) * 8);
+    if (fseek(this->file, static_cast<long>(HEADER_SIZE), SEEK_SET) != 0
+            || fread(index.data(), 1, index.size(), this->file) != index.size()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t offset = read32(&index[i * 8 + 4]);
+        if (offset > static_cast<size_t>(size) || static_cast<size_t>(size) - offset < PAGE_BYTES) return false;
+        Page page = {offset, false, vector<int32_t>()};
+        this->pages[read32(&index[i * 8])] = page;
+    }
+    return true;
+}
+
+RecordStore::Page *RecordStore::find_page(int level, bool create) {
+    uint32_t number = static_cast<uint32_t>(level) / PAGE_LEVELS;
+    map<uint32_t, Page>::iterator found = this->pages.find(number);
+    if (found == this->pages.end()) {
+        if (!create) return nullptr;
+        Page page = {0, true, vector<int32_t>(PAGE_LEVELS, -1)};
+        return &(this->pages[number] = page);
+    }
+    Page &page = found->second;
+    if (!page.loaded && !this->load_page(page)) {
+        // Unreadable pages count as empty and are replaced on the next write
+        this->valid = false;
+        page.values.assign(PAGE_LEVELS, -1);
+        page.loaded = true;
+    }
+    return &page;
+}
+
+bool RecordStore::load_page(Page &page) {
+    PIPES_TRACE_SCOPE("RecordStore::load_page");
+    unsigned char data[PAGE_BYTES];
+    if (this->file == nullptr || fseek(this->file, static_cast<long>(page.offset), SEEK_SET) != 0
+            || fread(data, 1, PAGE_BYTES, this->file) != PAGE_BYTES) {
+        return false;
+    }
+    page.values.resize(PAGE_LEVELS);
+    for (int i = 0; i < PAGE_LEVELS; ++i) {
+        page.values[i] = static_cast<int32_t>(read32(data + 4 * i));
+    }
+    page.loaded = true;
+    return true;
+}
+
+int RecordStore::get_record(int level) {
+    if (level < 0) return -1;
+    lock_guard<mutex> lock(this->guard);
+    Page *page = this->find_page(level, false);
+    return page == nullptr ? -1 : page->values[level % PAGE_LEVELS];
+}
+
+void RecordStore::update_record(int level, int value) {
+    if (level < 0) return;
+    {
+        lock_guard<mutex> lock(this->guard);
+        this->find_page(level, true)->values[level % PAGE_LEVELS] = value;
+        this->pending = true;
+        ++this->requested;
+    }
+    this->changed.notify_all();
+}
+
+bool RecordStore::flush() {
+    unique_lock<mutex> lock(this->guard);
+    uint64_t target = this->requested;
+    ++this->flushing;
+    this->changed.notify_all();
+    this->saved.wait(lock, [&]() { return this->completed >= target; });
+    --this->flushing;
+    return !this->failed;
+}
+
+// Writes every page to a new file and renames it over the old one
+bool RecordStore::write() {
+    PIPES_TRACE_SCOPE("RecordStore::write");
+    struct Snapshot {
+        uint32_t number;
+        uint32_t offset;
+        vector<int32_t> values;
+    };
+    vector<Snapshot> snapshot;
+    {
+        lock_guard<mutex> lock(this->guard);
+        for (map<uint32_t, Page>::const_iterator it = this->pages.begin(); it != this->pages.end(); ++it) {
+            Snapshot page = {it->first, it->second.offset, it->second.loaded ? it->second.values : vector<int32_t>()};
+            snapshot.push_back(page);
+        }
+    }
+
+    // Only the writer replaces the file, so the old one can be read without the lock
+    vector<unsigned char> data(MAGIC, MAGIC + sizeof(MAGIC));
+    write32(data, VERSION);
+    write32(data, static_cast<uint32_t>(snapshot.size()));
+    size_t offset = HEADER_SIZE + snapshot.size() * 8;
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        write32(data, snapshot[i].number);
+        write32(data, static_cast<uint32_t>(offset + i * PAGE_BYTES));
+    }
+    FILE *source = nullptr;
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        if (snapshot[i].values.empty()) {
+            unsigned char page[PAGE_BYTES];
+            if (source == nullptr) source = fopen(this->path.c_str(), "rb");
+            if (source == nullptr || fseek(source, static_cast<long>(snapshot[i].offset), SEEK_SET) != 0
+                    || fread(page, 1, PAGE_BYTES, source) != PAGE_BYTES) {
+                if (source != nullptr) fclose(source);
+                return false;
+            }
+            data.insert(data.end(), page, page + PAGE_BYTES);
+        } else {
+            for (int j = 0; j < PAGE_LEVELS; ++j) {
+                write32(data, static_cast<uint32_t>(snapshot[i].values[j]));
+            }
+        }
+    }
+    if (source != nullptr) fclose(source);
+
+    string temporary = this->path + ".tmp";
+    FILE *out = fopen(temporary.c_str(), "wb");
+    if (out == nullptr) return false;
+    bool written = fwrite(data.data(), 1, data.size(), out) == data.size() && syncFile(out);
+    written = fclose(out) == 0 && written;
+    if (!written) {
+        remove(temporary.c_str());
+        return false;
+    }
+
+    lock_guard<mutex> lock(this->guard);
+    if (this->file != nullptr) {
+        fclose(this->file);
+        this->file = nullptr;
+    }
+    bool renamed = replaceFile(temporary, this->path);
+    this->file = fopen(this->path.c_str(), "rb");
+    if (!renamed) return false;
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        this->pages[snapshot[i].number].offset = static_cast<uint32_t>(offset + i * PAGE_BYTES);
+    }
+    return syncDirectory(this->path);
+}
+
+void RecordStore::work() {
+    unique_lock<mutex> lock(this->guard);
+    while (true) {
+        this->changed.wait(lock, [&]() { return this->pending || this->stopping || this->flushing > 0; });
+        if (!this->pending) {
+            if (this->stopping) break;
+            this->completed = this->requested;
+            this->saved.notify_all();
+            this->changed.wait(lock, [&]() { return this->pending || this->stopping || this->flushing == 0; });
+            continue;
+        }
+
+        // Let more updates arrive before touching the disk
+        this->changed.wait_for(lock, chrono::milliseconds(BATCH_DELAY),
+                               [&]() { return this->stopping || this->flushing > 0; });
+        this->pending = false;
+        uint64_t target = this->requested;
+        lock.unlock();
+        bool written = this->write();
+        lock.lock();
+        this->failed = !written;
+        this->completed = target;
+        this->saved.notify_all();
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef RECORDSTORE_H
+#define RECORDSTORE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Best results of one player, for any number of levels. The file is split into
+// pages of PAGE_LEVELS records; only the page index is read when the store
+// opens, and a page is read the first time one of its levels is asked for.
+// Pages without any record are not stored at all.
+//
+//   "PIPESCOR" u32 version u32 pageCount
+//   pageCount * (u32 page, u32 offset), sorted by page
+//   pages of PAGE_LEVELS little-endian i32, -1 for no record
+//
+// Updates return at once. A writer thread collects them for BATCH_DELAY ms and
+// then writes a new file next to the old one and renames it over, so the file
+// on disk is always either the old or the new version.
+class RecordStore
+{
+ public:
+    static const uint32_t VERSION = 1;
+    static const int PAGE_LEVELS = 1024;
+    static const int BATCH_DELAY = 200;
+
+    explicit RecordStore(const std::string &_path);
+    // Writes whatever is still pending
+    ~RecordStore();
+
+    bool is_valid() const;
+    // -1 when the level has no record
+    int get_record(int level);
+    void update_record(int level, int value);
+    // Blocks until every update so far is on disk, false if writing failed
+    bool flush();
+
+ private:
+    struct Page {
+        uint32_t offset;
+        bool loaded;
+        std::vector<int32_t> values;
+    };
+
+    std::string path;
+    bool valid;
+    std::map<uint32_t, Page> pages;
+    FILE *file;
+
+    std::mutex guard;
+    std::condition_variable changed;
+    std::condition_variable saved;
+    std::thread writer;
+    bool pending;
+    int flushing;
+    bool stopping;
+    bool failed;
+    uint64_t requested;
+    uint64_t completed;
+
+    bool open();
+    Page *find_page(int level, bool create);
+    bool load_page(Page &page);
+    bool write();
+    void work();
+
+    RecordStore(const RecordStore &);
+    RecordStore &operator=(const RecordStore &);
+};
+
+#endif // RECORDSTORE_H
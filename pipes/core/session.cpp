@@ -0,0 +1,49 @@
+#include "session.h"
+#include "trace.h"
+
+GameSession::GameSession(const Board &_board, uint64_t _seed, int _flags):
+    board(_board),
+    random(_seed),
+    steps(0),
+    flags(_flags)
+{
+}
+
+bool GameSession::rotate(int y, int x) {
+    if (!this->board.contains(y, x)) return false;
+    if (this->board.get_type(y, x) == BlockType::EMPTY) return true;
+    this->board.rotate(y, x);
+    ++this->steps;
+    return true;
+}
+
+int GameSession::swipe(SwipeDirection direction) {
+    PIPES_TRACE_SCOPE("GameSession::swipe");
+    ::swipe(this->board, direction);
+    if (!(this->flags & SPAWNS)) return -1;
+    return addRandomPipe(this->board, this->random);
+}
+
+BFSResult GameSession::evaluate() const {
+    return ::evaluate(this->board);
+}
+
+const Board &GameSession::get_board() const {
+    return this->board;
+}
+
+int GameSession::get_steps() const {
+    return this->steps;
+}
+
+int GameSession::get_flags() const {
+    return this->flags;
+}
+
+Board featureBoard(int size, Random &random) {
+    Board board(size, size);
+    for (int i = 0; i < size; ++i) {
+        addRandomPipe(board, random);
+    }
+    return board;
+}
@@ -0,0 +1,41 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <cstdint>
+
+#include "board.h"
+#include "evaluator.h"
+#include "random.h"
+#include "swipe.h"
+
+// One game without a window, following the rules of GameInstance: clicks on
+// empty blocks are ignored, every other click is a step, and with SPAWNS a
+// swipe is followed by a new pipe. Small enough to keep thousands around.
+class GameSession
+{
+ public:
+    static const int SPAWNS = 1;
+
+    GameSession(const Board &_board, uint64_t _seed, int _flags);
+
+    // False when (y, x) is outside the board
+    bool rotate(int y, int x);
+    // The cell of the new pipe y * width + x, or -1 if none appeared
+    int swipe(SwipeDirection direction);
+    BFSResult evaluate() const;
+
+    const Board &get_board() const;
+    int get_steps() const;
+    int get_flags() const;
+
+ private:
+    Board board;
+    Random random;
+    int steps;
+    int flags;
+};
+
+// The feature mode start: `size` random pipes on an empty board
+Board featureBoard(int size, Random &random);
+
+#endif // SESSION_H
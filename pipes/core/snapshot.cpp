@@ -0,0 +1,44 @@
+#include "snapshot.h"
+
+// Blocks stream through a word-sized buffer, the low bits going first
+
+void packBoard(const Board &board, uint64_t *words) {
+    const int blocks = board.get_height() * board.get_width();
+    const unsigned char *cells = board.get_cells();
+    uint64_t buffer = 0;
+    int bits = 0;
+    for (int i = 0; i < blocks; ++i) {
+        uint64_t cell = cells[i];
+        buffer |= cell << bits;
+        bits += PACKED_BLOCK_BITS;
+        if (bits >= 64) {
+            *words++ = buffer;
+            bits -= 64;
+            buffer = bits > 0 ? cell >> (PACKED_BLOCK_BITS - bits) : 0;
+        }
+    }
+    if (bits > 0) *words = buffer;
+}
+
+void unpackBoard(const uint64_t *words, Board &board) {
+    const int height = board.get_height();
+    const int width = board.get_width();
+    uint64_t buffer = 0;
+    int bits = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint64_t cell;
+            if (bits >= PACKED_BLOCK_BITS) {
+                cell = buffer;
+                buffer >>= PACKED_BLOCK_BITS;
+                bits -= PACKED_BLOCK_BITS;
+            } else {
+                uint64_t word = *words++;
+                cell = buffer | word << bits;
+                buffer = word >> (PACKED_BLOCK_BITS - bits);
+                bits += 64 - PACKED_BLOCK_BITS;
+            }
+            board.set_cell(y, x, static_cast<unsigned char>(cell & 31));
+        }
+    }
+}
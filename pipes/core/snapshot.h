@@ -0,0 +1,21 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+
+#include "board.h"
+
+// Blocks packed five bits each, the encoded cell of Board, in row-major order
+// and straddling word boundaries, so an 8x8 board takes 40 bytes. The height
+// and width are not stored.
+static const int PACKED_BLOCK_BITS = 5;
+
+inline int packedWords(int height, int width) {
+    return (height * width * PACKED_BLOCK_BITS + 63) / 64;
+}
+
+void packBoard(const Board &board, uint64_t *words);
+// `board` must already have the packed size
+void unpackBoard(const uint64_t *words, Board &board);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,167 @@
+#include <climits>
+
+#include "solver.h"
+
+using namespace std;
+
+static const int MASKS = 1 << 4;
+
+Solver::Solver(const Board &_board):
+    board(_board),
+    height(_board.get_height()),
+    width(_board.get_width()),
+    cost(static_cast<size_t>(height) * width * MASKS, -1),
+    masks(static_cast<size_t>(height) * width, -1),
+    required(static_cast<size_t>(height) * width, 0),
+    bestSteps(INT_MAX)
+{
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) {
+            int index = y * this->width + x;
+            BlockType type = this->board.get_type(y, x);
+            int orientation = this->board.get_orientation(y, x);
+            // Empty blocks can not be rotated nor carry water
+            if (type == BlockType::EMPTY) continue;
+            for (int step = 3; step >= 0; --step) {
+                this->cost[index * MASKS + pipeDirection(type, (orientation + step) % 4)] = step;
+            }
+        }
+    }
+}
+
+// Masks the block may take without leaking into its assigned neighbours or the
+// border, cheapest first
+int Solver::candidates(int index, int *candidateMasks) {
+    const int y = index / this->width;
+    const int x = index % this->width;
+    const int last = this->height * this->width - 1;
+
+    int need = this->required[index];
+    int forbid = 0;
+    for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+        int ny = y + deltaY(direction);
+        int nx = x + deltaX(direction);
+        if (ny < 0 || nx < 0 || ny >= this->height || nx >= this->width) {
+            bool inlet = index == 0 && direction == LEFT;
+            bool outlet = index == last && direction == RIGHT;
+            if (!inlet && !outlet) forbid |= direction;
+            continue;
+        }
+        int neighbour = this->masks[ny * this->width + nx];
+        if (neighbour >= 0 && (neighbour & oppositeDirection(direction)) == 0) {
+            forbid |= direction;
+        }
+    }
+    // A wet outlet block must drain into the outlet
+    if (index == last) need |= RIGHT;
+
+    int count = 0;
+    for (int step = 0; step < 4; ++step) {
+        for (int mask = 0; mask < MASKS; ++mask) {
+            if (this->cost[index * MASKS + mask] != step) continue;
+            if ((mask & need) != need || (mask & forbid) != 0) continue;
+            candidateMasks[count++] = mask;
+        }
+    }
+    return count;
+}
+
+void Solver::assign(int index, int mask, size_t &pendingSize) {
+    pendingSize = this->pending.size();
+    this->masks[index] = mask;
+    const int y = index / this->width;
+    const int x = index % this->width;
+    for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+        if ((mask & direction) == 0) continue;
+        int ny = y + deltaY(direction);
+        int nx = x + deltaX(direction);
+        if (ny < 0 || nx < 0 || ny >= this->height || nx >= this->width) continue;
+        int neighbour = ny * this->width + nx;
+        if (this->masks[neighbour] >= 0) continue;
+        if (this->required[neighbour] == 0) {
+            this->pending.push_back(neighbour);
+        }
+        this->required[neighbour] |= oppositeDirection(direction);
+    }
+}
+
+void Solver::unassign(int index, int mask, size_t pendingSize) {
+    const int y = index / this->width;
+    const int x = index % this->width;
+    for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+        if ((mask & direction) == 0) continue;
+        int ny = y + deltaY(direction);
+        int nx = x + deltaX(direction);
+        if (ny < 0 || nx < 0 || ny >= this->height || nx >= this->width) continue;
+        int neighbour = ny * this->width + nx;
+        if (this->masks[neighbour] >= 0) continue;
+        this->required[neighbour] &= ~oppositeDirection(direction);
+    }
+    this->masks[index] = -1;
+    this->pending.resize(pendingSize);
+}
+
+void Solver::search(int steps) {
+    // Pick the most constrained pending block while summing a lower bound
+    int chosen = -1;
+    int chosenCount = 5;
+    int chosenMasks[4];
+    int bound = steps;
+    for (size_t i = 0; i < this->pending.size(); ++i) {
+        int index = this->pending[i];
+        if (this->masks[index] >= 0) continue;
+        int options[4];
+        int count = this->candidates(index, options);
+        if (count == 0) return;
+        bound += this->cost[index * MASKS + options[0]];
+        if (bound >= this->bestSteps) return;
+        if (count < chosenCount) {
+            chosen = index;
+            chosenCount = count;
+            for (int k = 0; k < count; ++k) {
+                chosenMasks[k] = options[k];
+            }
+        }
+    }
+
+    // No open pipe end left: the wet region is closed
+    if (chosen < 0) {
+        if (this->masks[this->height * this->width - 1] >= 0) {
+            this->bestSteps = steps;
+            this->best = this->masks;
+        }
+        return;
+    }
+
+    for (int k = 0; k < chosenCount; ++k) {
+        int mask = chosenMasks[k];
+        size_t pendingSize;
+        this->assign(chosen, mask, pendingSize);
+        this->search(steps + this->cost[chosen * MASKS + mask]);
+        this->unassign(chosen, mask, pendingSize);
+    }
+}
+
+Solution Solver::solve(int upperBound) {
+    this->bestSteps = upperBound < 0 ? INT_MAX : upperBound;
+    this->best.clear();
+    this->pending.assign(1, 0);
+    this->required[0] = LEFT;
+    this->search(0);
+    this->required[0] = 0;
+    this->pending.clear();
+
+    Solution solution{!this->best.empty(), this->best.empty() ? -1 : this->bestSteps, {}};
+    solution.orientations.resize(this->masks.size());
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) {
+            int index = y * this->width + x;
+            int orientation = this->board.get_orientation(y, x);
+            if (solution.solvable && this->best[index] >= 0) {
+                orientation = (orientation + this->cost[index * MASKS + this->best[index]]) % 4;
+            }
+            solution.orientations[index] = orientation;
+        }
+    }
+    return solution;
+}
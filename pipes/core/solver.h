@@ -0,0 +1,47 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "board.h"
+
+struct Solution {
+    bool solvable;
+    // Clockwise rotations needed to reach CONNECTED
+    int steps;
+    // Target orientation of each block y * width + x
+    std::vector<int> orientations;
+};
+
+// Minimum-rotation solver. The wet region is grown from the inlet one block at
+// a time: every open pipe end constrains the block it points at, the most
+// constrained block is branched on first, and branches that can not beat the
+// best solution so far are cut.
+class Solver
+{
+ public:
+    explicit Solver(const Board &_board);
+
+    // Solutions costing `upperBound` steps or more are not searched for
+    Solution solve(int upperBound = -1);
+
+ private:
+    const Board &board;
+    int height;
+    int width;
+    // cost[index * 16 + mask]: rotations for the block to show exactly `mask`, -1 if it never can
+    std::vector<int> cost;
+    std::vector<int> masks;
+    std::vector<int> required;
+    std::vector<int> pending;
+    std::vector<int> best;
+    int bestSteps;
+
+    int candidates(int index, int *candidateMasks);
+    void assign(int index, int mask, std::size_t &pendingSize);
+    void unassign(int index, int mask, std::size_t pendingSize);
+    void search(int steps);
+};
+
+#endif // SOLVER_H
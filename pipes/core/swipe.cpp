@@ -0,0 +1,308 @@
+#include <cstdint>
+#include <vector>
+
+#include "swipe.h"
+#include "trace.h"
+
+namespace {
+
+const int TABLE_LINE = 8;
+const unsigned char EMPTY_CELL = BlockType::EMPTY;
+
+// Lines of n non-empty blocks start at (4^n - 1) / 3, the types packed 2 bits each
+inline int lineIndex(int count, int types) {
+    return ((1 << (2 * count)) - 1) / 3 + types;
+}
+
+// Entry bits 0-7 mark the blocks that survive, bits 8-23 hold the types of the
+// survivors in order
+std::vector<uint32_t> buildTable() {
+    std::vector<uint32_t> table(static_cast<std::size_t>(lineIndex(TABLE_LINE + 1, 0)));
+    for (int count = 0; count <= TABLE_LINE; ++count) {
+        for (int types = 0; types < (1 << (2 * count)); ++types) {
+            BlockData line[TABLE_LINE];
+            for (int i = 0; i < count; ++i) {
+                line[i].type = static_cast<BlockType>((types >> (2 * i)) & 3);
+                line[i].orientation = 0;
+            }
+
+            // Same scan as the generic swipe
+            BlockType leftType = BlockType::EMPTY;
+            int leftIndex = -1;
+            for (int i = 0; i < count; ++i) {
+                if (leftType == BlockType::EMPTY || line[i].type != leftType) {
+                    leftType = line[i].type;
+                    leftIndex = i;
+                } else {
+                    combine(line[leftIndex], line[i]);
+                    leftType = BlockType::EMPTY;
+                    leftIndex = -1;
+                }
+            }
+
+            uint32_t entry = 0;
+            int survivors = 0;
+            for (int i = 0; i < count; ++i) {
+                if (line[i].type == BlockType::EMPTY) continue;
+                entry |= 1u << i;
+                entry |= static_cast<uint32_t>(line[i].type) << (8 + 2 * survivors++);
+            }
+            table[lineIndex(count, types)] = entry;
+        }
+    }
+    return table;
+}
+
+const std::vector<uint32_t> &swipeTable() {
+    static const std::vector<uint32_t> table = buildTable();
+    return table;
+}
+
+// Lines longer than the table, in place
+void swipeLongLine(Board &board, int y, int x, int dy, int dx, int size) {
+    BlockType leftType = BlockType::EMPTY;
+    int leftIndex = -1;
+    for (int i = 0; i < size; ++i) {
+        BlockType type = board.get_type(y + dy * i, x + dx * i);
+        if (type == BlockType::EMPTY) {
+            continue;
+        }
+        if (leftType == BlockType::EMPTY || type != leftType) {
+            leftType = type;
+            leftIndex = i;
+        } else {
+            BlockData destination = board.get_block(y + dy * leftIndex, x + dx * leftIndex);
+            BlockData part = board.get_block(y + dy * i, x + dx * i);
+            combine(destination, part);
+            board.set_block(y + dy * leftIndex, x + dx * leftIndex, destination);
+            board.set_block(y + dy * i, x + dx * i, part);
+            leftType = BlockType::EMPTY;
+            leftIndex = -1;
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < size; ++i) {
+        unsigned char cell = board.get_cell(y + dy * i, x + dx * i);
+        if ((cell & 7) != BlockType::EMPTY) {
+            board.set_cell(y + dy * count, x + dx * count, cell);
+            ++count;
+        }
+    }
+    for (; count < size; ++count) {
+        board.set_cell(y + dy * count, x + dx * count, EMPTY_CELL);
+    }
+}
+
+// Pushes the line starting at (y, x) towards its start, (dy, dx) points away from it
+void swipeLine(Board &board, int y, int x, int dy, int dx, int size) {
+    if (size > TABLE_LINE) {
+        swipeLongLine(board, y, x, dy, dx, size);
+        return;
+    }
+
+    unsigned char blocks[TABLE_LINE];
+    int count = 0;
+    int types = 0;
+    for (int i = 0; i < size; ++i) {
+        unsigned char cell = board.get_cell(y + dy * i, x + dx * i);
+        if ((cell & 7) == BlockType::EMPTY) continue;
+        types |= (cell & 3) << (2 * count);
+        blocks[count++] = cell;
+    }
+
+    uint32_t entry = swipeTable()[lineIndex(count, types)];
+    int position = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!(entry & (1u << i))) continue;
+        unsigned char type = static_cast<unsigned char>((entry >> (8 + 2 * position)) & 3);
+        board.set_cell(y + dy * position, x + dx * position, static_cast<unsigned char>((blocks[i] & ~7) | type));
+        ++position;
+    }
+    for (; position < size; ++position) {
+        board.set_cell(y + dy * position, x + dx * position, EMPTY_CELL);
+    }
+}
+
+// What two equal blocks merge into, EMPTY when they do not merge
+constexpr unsigned char MERGED_TYPE[4] = {STRAIGHT, EMPTY, TURN, TJUNCTION};
+
+// Square boards of a size known at compile time: each line is copied out,
+// merged and written back with constant bounds and strides
+template <int N>
+void swipeSized(Board &board, SwipeDirection direction) {
+    const int along = direction == SWIPE_LEFT ? 1 : direction == SWIPE_RIGHT ? -1 : direction == SWIPE_UP ? N : -N;
+    const unsigned char *cells = board.get_cells();
+    for (int line = 0; line < N; ++line) {
+        int start;
+        switch (direction) {
+        case SWIPE_LEFT:
+            start = line * N; break;
+        case SWIPE_RIGHT:
+            start = line * N + N - 1; break;
+        case SWIPE_UP:
+            start = line; break;
+        default:
+            start = (N - 1) * N + line;
+        }
+
+        unsigned char blocks[N];
+        int count = 0;
+        for (int i = 0; i < N; ++i) {
+            unsigned char cell = cells[start + along * i];
+            if ((cell & 7) != BlockType::EMPTY) blocks[count++] = cell;
+        }
+
+        // Same scan as the generic swipe
+        int left = -1;
+        for (int i = 0; i < count; ++i) {
+            int type = blocks[i] & 7;
+            if (left < 0 || type != (blocks[left] & 7)) {
+                left = i;
+                continue;
+            }
+            if (MERGED_TYPE[type] != BlockType::EMPTY) {
+                blocks[left] = static_cast<unsigned char>((blocks[left] & ~7) | MERGED_TYPE[type]);
+                blocks[i] = EMPTY_CELL;
+            }
+            left = -1;
+        }
+
+        int position = 0;
+        for (int i = 0; i < count; ++i) {
+            if (blocks[i] == EMPTY_CELL) continue;
+            int index = start + along * position++;
+            board.set_cell(index / N, index % N, blocks[i]);
+        }
+        for (; position < N; ++position) {
+            int index = start + along * position;
+            board.set_cell(index / N, index % N, EMPTY_CELL);
+        }
+    }
+}
+
+// False for the sizes left to the generic kernels. Lines of up to TABLE_LINE
+// blocks are faster still through the table.
+bool swipeFixed(Board &board, SwipeDirection direction) {
+    if (board.get_height() != board.get_width()) return false;
+    switch (board.get_height()) {
+    case 16:
+        swipeSized<16>(board, direction);
+        return true;
+    case 32:
+        swipeSized<32>(board, direction);
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+void combine(BlockData &destination, BlockData &part) {
+    if (destination.type != part.type) return;
+    switch (destination.type) {
+    case BlockType::EMPTY:
+    case BlockType::TURN:
+        return;
+    case BlockType::CROSS:
+        destination.type = BlockType::TJUNCTION;
+        break;
+    case BlockType::TJUNCTION:
+        destination.type = BlockType::STRAIGHT;
+        break;
+    case BlockType::STRAIGHT:
+        destination.type = BlockType::TURN;
+        break;
+    }
+    part.type = BlockType::EMPTY;
+}
+
+void rotateClockwise(Board &board) {
+    const int size = board.get_height();
+    Board result{size, size};
+
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            result.set_block(j, size - i - 1, board.get_block(i, j));
+        }
+    }
+    board = result;
+}
+
+// Blocks keep their orientation when they move, so every direction is the same
+// line kernel walked from the side the blocks are pushed to
+void swipeLeft(Board &board) {
+    PIPES_TRACE_SCOPE("swipeLeft");
+    if (swipeFixed(board, SWIPE_LEFT)) return;
+    for (int y = 0; y < board.get_height(); ++y) {
+        swipeLine(board, y, 0, 0, 1, board.get_width());
+    }
+}
+
+void swipeRight(Board &board) {
+    PIPES_TRACE_SCOPE("swipeRight");
+    if (swipeFixed(board, SWIPE_RIGHT)) return;
+    for (int y = 0; y < board.get_height(); ++y) {
+        swipeLine(board, y, board.get_width() - 1, 0, -1, board.get_width());
+    }
+}
+
+void swipeUp(Board &board) {
+    PIPES_TRACE_SCOPE("swipeUp");
+    if (swipeFixed(board, SWIPE_UP)) return;
+    for (int x = 0; x < board.get_width(); ++x) {
+        swipeLine(board, 0, x, 1, 0, board.get_height());
+    }
+}
+
+void swipeDown(Board &board) {
+    PIPES_TRACE_SCOPE("swipeDown");
+    if (swipeFixed(board, SWIPE_DOWN)) return;
+    for (int x = 0; x < board.get_width(); ++x) {
+        swipeLine(board, board.get_height() - 1, x, -1, 0, board.get_height());
+    }
+}
+
+void swipe(Board &board, SwipeDirection direction) {
+    switch (direction) {
+    case SWIPE_LEFT:
+        swipeLeft(board); break;
+    case SWIPE_UP:
+        swipeUp(board); break;
+    case SWIPE_RIGHT:
+        swipeRight(board); break;
+    case SWIPE_DOWN:
+        swipeDown(board);
+    }
+}
+
+int addRandomPipe(Board &board, Random &random, int types) {
+    PIPES_TRACE_SCOPE("addRandomPipe");
+    int size = 0;
+    for (int y = 0; y < board.get_height(); ++y) {
+        for (int x = 0; x < board.get_width(); ++x) {
+            if (board.get_type(y, x) == BlockType::EMPTY) ++size;
+        }
+    }
+    if (size == 0 || (types & 15) == 0) return -1;
+
+    int index = random.next_int(size);
+    BlockType choices[4];
+    int choiceCount = 0;
+    for (int type = 0; type < BlockType::EMPTY; ++type) {
+        if (types & (1 << type)) choices[choiceCount++] = static_cast<BlockType>(type);
+    }
+    BlockType type = choices[random.next_int(choiceCount)];
+    int orientation = random.next_int(4);
+
+    for (int y = 0; y < board.get_height(); ++y) {
+        for (int x = 0; x < board.get_width(); ++x) {
+            if (board.get_type(y, x) == BlockType::EMPTY && index-- == 0) {
+                board.set_block(y, x, type, orientation);
+                return y * board.get_width() + x;
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,25 @@
+#ifndef SWIPE_H
+#define SWIPE_H
+
+#include "board.h"
+#include "random.h"
+
+enum SwipeDirection {SWIPE_LEFT, SWIPE_UP, SWIPE_RIGHT, SWIPE_DOWN};
+
+// Block types that may appear after a move, one bit per BlockType
+static const int SPAWN_TYPES = (1 << BlockType::STRAIGHT) | (1 << BlockType::CROSS);
+
+// 2048-style moves of the feature mode, on square boards
+void combine(BlockData &destination, BlockData &part);
+void rotateClockwise(Board &board);
+void swipeLeft(Board &board);
+void swipeRight(Board &board);
+void swipeUp(Board &board);
+void swipeDown(Board &board);
+void swipe(Board &board, SwipeDirection direction);
+
+// Puts a block of one of `types`, in any orientation, on a random empty cell.
+// Returns the cell y * width + x, or -1 if the board is full.
+int addRandomPipe(Board &board, Random &random, int types = SPAWN_TYPES);
+
+#endif // SWIPE_H
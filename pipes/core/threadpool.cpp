@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <atomic>
+
+#include "threadpool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads):
+    busy(0),
+    stopping(false)
+{
+    if (threads <= 0) {
+        threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threads; ++i) {
+        this->workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(this->guard);
+        this->stopping = true;
+    }
+    this->available.notify_all();
+    for (size_t i = 0; i < this->workers.size(); ++i) {
+        this->workers[i].join();
+    }
+}
+
+int ThreadPool::get_size() const {
+    return static_cast<int>(this->workers.size());
+}
+
+void ThreadPool::run(const function<void()> &task) {
+    {
+        lock_guard<mutex> lock(this->guard);
+        this->tasks.push_back(task);
+    }
+    this->available.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(this->guard);
+    this->finished.wait(lock, [this]() { return this->tasks.empty() && this->busy == 0; });
+}
+
+void ThreadPool::for_each(int count, const function<void(int)> &task) {
+    // One task per worker pulling indices keeps the queue short
+    atomic<int> next(0);
+    int chunks = min(count, this->get_size());
+    for (int i = 0; i < chunks; ++i) {
+        this->run([&next, count, &task]() {
+            for (int index = next++; index < count; index = next++) {
+                task(index);
+            }
+        });
+    }
+    this->wait();
+}
+
+void ThreadPool::work() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(this->guard);
+            this->available.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+            if (this->tasks.empty()) return;
+            task = this->tasks.front();
+            this->tasks.pop_front();
+            ++this->busy;
+        }
+        task();
+        {
+            lock_guard<mutex> lock(this->guard);
+            --this->busy;
+            if (this->tasks.empty() && this->busy == 0) {
+                this->finished.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running queued tasks
+class ThreadPool
+{
+ public:
+    // All cores when `threads` is 0
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int get_size() const;
+    void run(const std::function<void()> &task);
+    // Block until every queued task has finished
+    void wait();
+    // Run task(i) for every i in [0, count) and wait for all of them
+    void for_each(int count, const std::function<void(int)> &task);
+
+ private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    std::mutex guard;
+    std::condition_variable available;
+    std::condition_variable finished;
+    int busy;
+    bool stopping;
+
+    void work();
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+};
+
+#endif // THREADPOOL_H
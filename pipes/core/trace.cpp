@@ -0,0 +1,119 @@
+#include "trace.h"
+
+#if defined(PIPES_TRACING)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// `sequence` is 2 * n + 1 while span n is written and 2 * n + 2 once it is
+// complete, so a reader can tell a finished span from a torn one
+struct Slot {
+    atomic<uint64_t> sequence;
+    atomic<const char *> name;
+    atomic<uint64_t> start;
+    atomic<uint64_t> duration;
+    atomic<uint32_t> thread;
+};
+
+struct Span {
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    uint32_t thread;
+};
+
+Slot slots[Trace::CAPACITY];
+atomic<uint64_t> head(0);
+atomic<uint32_t> threads(0);
+
+uint32_t threadId() {
+    static thread_local uint32_t id = ++threads;
+    return id;
+}
+
+bool readSlot(uint64_t index, Span &span) {
+    const Slot &slot = slots[index & (Trace::CAPACITY - 1)];
+    uint64_t sequence = slot.sequence.load(memory_order_acquire);
+    if (sequence != 2 * index + 2) return false;
+    span.name = slot.name.load(memory_order_relaxed);
+    span.start = slot.start.load(memory_order_relaxed);
+    span.duration = slot.duration.load(memory_order_relaxed);
+    span.thread = slot.thread.load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    return slot.sequence.load(memory_order_relaxed) == sequence;
+}
+
+bool sameName(const char *a, const char *b) {
+    return a == b || (a != nullptr && b != nullptr && string(a) == b);
+}
+
+double percentile(const vector<uint64_t> &sorted, int percent) {
+    return sorted[(sorted.size() - 1) * percent / 100] / 1000.0;
+}
+
+}
+
+uint64_t Trace::now() {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Trace::record(const char *name, uint64_t start, uint64_t duration) {
+    uint64_t index = head.fetch_add(1, memory_order_relaxed);
+    Slot &slot = slots[index & (CAPACITY - 1)];
+    slot.sequence.store(2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot.name.store(name, memory_order_relaxed);
+    slot.start.store(start, memory_order_relaxed);
+    slot.duration.store(duration, memory_order_relaxed);
+    slot.thread.store(threadId(), memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, memory_order_release);
+}
+
+TraceStats Trace::stats(const char *name, int last) {
+    vector<uint64_t> durations;
+    uint64_t end = head.load(memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    for (uint64_t index = end; index > begin && static_cast<int>(durations.size()) < last; --index) {
+        Span span;
+        if (readSlot(index - 1, span) && sameName(span.name, name)) durations.push_back(span.duration);
+    }
+
+    TraceStats stats = {static_cast<int>(durations.size()), 0, 0, 0, 0};
+    if (durations.empty()) return stats;
+    sort(durations.begin(), durations.end());
+    stats.p50 = percentile(durations, 50);
+    stats.p90 = percentile(durations, 90);
+    stats.p99 = percentile(durations, 99);
+    stats.max = durations.back() / 1000.0;
+    return stats;
+}
+
+bool Trace::dump_json(const string &path) {
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+
+    fputs("{\"traceEvents\":[", file);
+    uint64_t end = head.load(memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    bool first = true;
+    for (uint64_t index = begin; index < end; ++index) {
+        Span span;
+        if (!readSlot(index, span)) continue;
+        // Span names are identifiers, nothing to escape
+        fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",", span.name, span.thread, span.start / 1000.0, span.duration / 1000.0);
+        first = false;
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    return fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Timing spans around the hot paths. Build with CONFIG += tracing to turn them
+// on; otherwise PIPES_TRACE_SCOPE expands to nothing and none of this exists.
+
+#if defined(PIPES_TRACING)
+
+#include <cstdint>
+#include <string>
+
+struct TraceStats {
+    int count;
+    // Microseconds
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+// Spans go into a fixed ring buffer shared by every thread. Writers claim a
+// slot with one atomic increment and never wait; the oldest spans are
+// overwritten once the buffer is full.
+class Trace
+{
+ public:
+    static const int CAPACITY = 1 << 16;
+
+    // Nanoseconds on a monotonic clock
+    static uint64_t now();
+    // `name` must outlive the trace, a string literal in practice
+    static void record(const char *name, uint64_t start, uint64_t duration);
+    // Percentiles of the latest `last` spans called `name`
+    static TraceStats stats(const char *name, int last = 1000);
+    // Chrome / Perfetto trace event JSON
+    static bool dump_json(const std::string &path);
+};
+
+class TraceScope
+{
+ public:
+    explicit TraceScope(const char *_name): name(_name), start(Trace::now()) {}
+    ~TraceScope() { Trace::record(this->name, this->start, Trace::now() - this->start); }
+
+ private:
+    const char *name;
+    uint64_t start;
+
+    TraceScope(const TraceScope &);
+    TraceScope &operator=(const TraceScope &);
+};
+
+#define PIPES_TRACE_CONCAT_(a, b) a##b
+#define PIPES_TRACE_CONCAT(a, b) PIPES_TRACE_CONCAT_(a, b)
+#define PIPES_TRACE_SCOPE(name) TraceScope PIPES_TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+
+#define PIPES_TRACE_SCOPE(name) do {} while (0)
+
+#endif
+
+#endif // TRACE_H
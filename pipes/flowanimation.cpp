@@ -0,0 +1,81 @@
+#include <algorithm>
+
+#include "flowanimation.h"
+#include "boardview.h"
+
+using namespace std;
+
+FlowAnimation::FlowAnimation(BoardView *_view, QObject *parent):
+    QObject(parent),
+    view(_view),
+    width(1),
+    layerTime(1),
+    duration(0),
+    shownLayers(0)
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setInterval(FRAME_TIME);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+// Layer i is shown after (i + 1) * layerTime ms, finished() is emitted after duration ms
+void FlowAnimation::start(const vector<int> &layers, int width, int layerTime, int duration)
+{
+    this->timer.stop();
+    this->width = width;
+    this->layerTime = max(1, layerTime);
+    this->duration = duration;
+    this->shownLayers = 0;
+
+    // Counting sort of the wet cells by layer
+    int layerCount = 0;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layerCount = max(layerCount, layers[i] + 1);
+    }
+    this->layerStart.assign(static_cast<size_t>(layerCount) + 1, 0);
+    for (size_t i = 0; i < layers.size(); ++i) {
+        if (layers[i] >= 0) ++this->layerStart[layers[i] + 1];
+    }
+    for (int i = 0; i < layerCount; ++i) {
+        this->layerStart[i + 1] += this->layerStart[i];
+    }
+    this->cells.resize(this->layerStart[layerCount]);
+    vector<int> next(this->layerStart.begin(), this->layerStart.end() - 1);
+    for (size_t i = 0; i < layers.size(); ++i) {
+        if (layers[i] >= 0) this->cells[next[layers[i]]++] = static_cast<int>(i);
+    }
+
+    this->clock.start();
+    this->timer.start();
+}
+
+void FlowAnimation::cancel()
+{
+    this->timer.stop();
+}
+
+bool FlowAnimation::is_running() const
+{
+    return this->timer.isActive();
+}
+
+void FlowAnimation::revealLayers(int count)
+{
+    int layerCount = static_cast<int>(this->layerStart.size()) - 1;
+    count = min(count, layerCount);
+    for (int end = this->layerStart[count], i = this->layerStart[this->shownLayers]; i < end; ++i) {
+        this->view->set_highlighted(this->cells[i] / this->width, this->cells[i] % this->width, true);
+    }
+    this->shownLayers = max(this->shownLayers, count);
+}
+
+void FlowAnimation::tick()
+{
+    // Catch up on every layer that is due, even if frames were dropped
+    qint64 elapsed = this->clock.elapsed();
+    this->revealLayers(static_cast<int>(elapsed / this->layerTime));
+    if (elapsed >= this->duration) {
+        this->timer.stop();
+        emit finished();
+    }
+}
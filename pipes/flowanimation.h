@@ -0,0 +1,46 @@
+#ifndef FLOWANIMATION_H
+#define FLOWANIMATION_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <vector>
+
+class BoardView;
+
+// Replays the water on a board view from one timer running at a fixed frame
+// rate. Each frame reveals every layer that is due, so the cost of a frame does
+// not depend on how many cells are wet.
+class FlowAnimation : public QObject
+{
+    Q_OBJECT
+
+ public:
+    static const int FRAME_TIME = 16;
+
+    FlowAnimation(BoardView *_view, QObject *parent = nullptr);
+    void start(const std::vector<int> &layers, int width, int layerTime, int duration);
+    void cancel();
+    bool is_running() const;
+
+ private:
+    BoardView *view;
+    QTimer timer;
+    QElapsedTimer clock;
+    int width;
+    int layerTime;
+    int duration;
+    int shownLayers;
+    // Cells sorted by layer, layer i is cells[layerStart[i]] .. cells[layerStart[i + 1]]
+    std::vector<int> cells;
+    std::vector<int> layerStart;
+    void revealLayers(int count);
+
+ private slots:
+    void tick();
+
+ signals:
+    void finished();
+};
+
+#endif // FLOWANIMATION_H
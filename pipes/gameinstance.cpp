@@ -1,210 +1,353 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 #include <QFile>
+#include <QFileInfo>
 #include <QString>
 #include <QObject>
 #include <QCloseEvent>
+#include <QKeyEvent>
+#include <QKeySequence>
 #include <QMessageBox>
-#include <QTimer>
-#include <queue>
+#include <QPushButton>
+#include <QtConcurrent>
+#include <memory>
+#include <vector>
 
 #include "gameinstance.h"
 #include "gamewindow.h"
 #include "loginwindow.h"
+#include "levelparser.h"
+#include "solver.h"
+#include "swipe.h"
+#include "trace.h"
 
 using namespace std;
 
 const QString GameInstance::map_path = ":/resources/maps/maps.txt";
+const QString GameInstance::pack_name = "maps.pack";
+const QString GameInstance::recording_dir =
+    QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/comp2012h_pipes/recordings";
 
-GameInstance::GameInstance(int _level, int _min_step):
+GameInstance::GameInstance():
+    flow(board),
     game_gui(new GameWindow(nullptr)),
+    view(game_gui->get_board_view()),
     used_step(0),
-    min_step(_min_step),
-    level(_level),
-    result(-1)
+    min_step(-1),
+    optimal_step(-1),
+    level(0),
+    result(-1),
+    follow_up(CLOSE),
+    random(Random::derive(static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()),
+                          static_cast<uint64_t>(QCoreApplication::applicationPid()))),
+    last_event(0),
+    animation(new FlowAnimation(view, this)),
+    checkedStatus(BFSStatus::STUCK)
 {
-    game_gui -> show();
-    game_gui -> set_lcd(GameWindow::USED_STEP_LCD, 0);
-    game_gui -> set_lcd(GameWindow::MIN_STEP_LCD, _min_step == -1 ? 999 : _min_step);
-    game_gui -> set_lcd(GameWindow::LEVEL_LCD, _level);
-    load_map(_level);
+    view -> set_board_size(board.get_height(), board.get_width());
     connect(game_gui -> get_done_button(), SIGNAL(clicked()), this, SLOT(on_done_button_clicked()));
     connect(game_gui, SIGNAL(closed()), this, SLOT(quit()));
-    if (level == featureLevel) {
-        connect(game_gui, SIGNAL(keyPressed(QKeyEvent*)), this, SLOT(keyPressed(QKeyEvent*)));
+    connect(view, SIGNAL(blockPressed(int,int)), this, SLOT(block_pressed(int,int)));
+    connect(animation, SIGNAL(finished()), this, SLOT(show_result()));
+    connect(game_gui, SIGNAL(hintRequested()), this, SLOT(request_hint()));
+    connect(game_gui, SIGNAL(hintDismissed()), this, SLOT(dismiss_hint()));
+    connect(&hint_watcher, SIGNAL(finished()), this, SLOT(show_hint()));
+    connect(game_gui, SIGNAL(keyPressed(QKeyEvent*)), this, SLOT(keyPressed(QKeyEvent*)));
+}
+
+// Resets everything a game changed; the blocks already on screen are only
+// redrawn where the new level differs
+void GameInstance::start(int _level, int _min_step)
+{
+    PIPES_TRACE_SCOPE("GameInstance::start");
+    this->animation->cancel();
+    this->isChecking = false;
+    this->checkedStatus = BFSStatus::STUCK;
+    this->hint_wanted = false;
+    this->view->set_hint(-1, -1);
+    this->history.clear();
+    this->used_step = 0;
+    this->min_step = _min_step;
+    this->result = -1;
+    this->follow_up = CLOSE;
+
+    if (_level == featureLevel) {
+        this->level = _level;
+        this->optimal_step = -1;
+        this->load_map(_level);
+    } else if (_level == this->level && this->recording.get_level() == _level) {
+        // A retry starts from the position the last game started from
+        PreparedLevel same = {_level, this->recording.get_start(), this->optimal_step};
+        this->load_prepared(same);
+    } else if (_level == this->prefetch_level) {
+        this->load_prepared(this->prefetch.result());
+        this->prefetch_level = 0;
+    } else {
+        this->load_prepared(prepare_level(_level));
     }
+
+    this->recording = Recording(board, random.get_state(), _level, _level == featureLevel ? Recording::SPAWNS : 0);
+    this->last_event = 0;
+    this->clock.start();
+
+    game_gui -> set_lcd(GameWindow::USED_STEP_LCD, 0);
+    game_gui -> set_lcd(GameWindow::LEVEL_LCD, _level);
+    // Show the true optimum until the player has a record of their own
+    int target = _min_step == -1 ? optimal_step : _min_step;
+    game_gui -> set_lcd(GameWindow::MIN_STEP_LCD, target == -1 ? 999 : target);
+    game_gui -> show();
+    game_gui -> raise();
+    game_gui -> activateWindow();
+}
+
+int GameInstance::get_level()
+{
+    return this->level;
+}
+
+GameInstance::FollowUp GameInstance::get_follow_up()
+{
+    return this->follow_up;
 }
 
 void GameInstance::init_block(int _type, int _orientation, int _y, int _x)
 {
-    Block* ret = new Block(game_gui, _y, _x, this, _type, _orientation);
-    connect(ret, SIGNAL(clicked()), ret, SLOT(pressed()));
-    blocks[_y][_x] = ret;
+    this->board.set_block(_y, _x, static_cast<BlockType>(_type), _orientation);
+    this->view->set_block(_y, _x, static_cast<BlockType>(_type), this->board.get_orientation(_y, _x));
 }
 
 void GameInstance::quit()
 {
+    this->animation->cancel();
+    this->save_recording();
     emit game_over();
 }
 
+// Loaded on first use and shared by every game. A level file named by
+// $PIPES_LEVELS, or a maps.pack next to the game, replaces the built-in levels.
+const LevelSource &GameInstance::levels()
+{
+    static unique_ptr<LevelSource> source;
+    if (!source) {
+        QString path = QString::fromLocal8Bit(qgetenv("PIPES_LEVELS"));
+        if (path.isEmpty()) {
+            path = QCoreApplication::applicationDirPath() + "/" + pack_name;
+        }
+        if (QFileInfo::exists(path)) {
+            ParseError error;
+            source = openLevels(QFile::encodeName(path).toStdString(), &error);
+            if (!source) {
+                qWarning("%s:%d:%d: %s", qPrintable(path), error.line, error.column, error.message.c_str());
+            }
+        }
+    }
+    if (!source) {
+        QFile mapFile{map_path};
+        mapFile.open(QIODevice::ReadOnly);
+        QByteArray data = mapFile.readAll();
+        unique_ptr<LevelTable> table(new LevelTable());
+        ParseError error;
+        if (!table->parse(data.constData(), static_cast<size_t>(data.size()), &error)) {
+            qWarning("%s:%d:%d: %s", qPrintable(map_path), error.line, error.column, error.message.c_str());
+        }
+        source.reset(table.release());
+    }
+    return *source;
+}
+
 void GameInstance::load_map(int dest_level)
 {
+    PIPES_TRACE_SCOPE("GameInstance::load_map");
     if (dest_level == featureLevel) {
         this->loadFeatureMap();
+        this->flow.reset();
+        this->refresh_flow();
         return;
     }
+    this->load_prepared(prepare_level(dest_level));
+}
+
+PreparedLevel GameInstance::prepare_level(int level)
+{
+    PIPES_TRACE_SCOPE("GameInstance::prepare_level");
+    Board loaded;
+    if (!levels().load_level(level, loaded)) {
+        qWarning("Level %d can not be loaded", level);
+    }
+    PreparedLevel prepared = {level, loaded, -1};
+    prepared.optimal_step = Solver(prepared.board).solve().steps;
+    return prepared;
+}
 
-    QFile mapFile{this->map_path};
-    mapFile.open(QIODevice::ReadOnly | QIODevice::Text);
-    QString data = mapFile.readAll();
-    // Split by block
-    QStringList mapData = data.split(QRegExp("(\\[|\\]\\n\\[|\\])"));
-    QString destMapData = mapData[dest_level];
-
-    QRegExp rex{"\\((\\d), (\\d)\\)"};
-    int pos = 0;
-    int block = 0;
-    while ((pos = rex.indexIn(destMapData, pos)) != -1) {
-        int type = rex.cap(1).toInt();
-        int orientation = rex.cap(2).toInt();
-        this->init_block(type, orientation, block / 8, block % 8);
-        ++block;
-        pos += rex.matchedLength();
+void GameInstance::load_prepared(const PreparedLevel &prepared)
+{
+    this->level = prepared.level;
+    this->resize_board(prepared.board.get_height(), prepared.board.get_width());
+    for (int y = 0; y < this->board.get_height(); ++y) {
+        for (int x = 0; x < this->board.get_width(); ++x) {
+            this->init_block(prepared.board.get_type(y, x), prepared.board.get_orientation(y, x), y, x);
+        }
     }
+    this->flow.reset();
+    this->refresh_flow();
+    this->optimal_step = prepared.optimal_step;
+}
+
+// The board and the view take the size of the level; LiveFlow picks it up on reset()
+void GameInstance::resize_board(int height, int width)
+{
+    if (this->board.get_height() == height && this->board.get_width() == width) return;
+    this->board = Board(height, width);
+    this->view->set_board_size(height, width);
+}
 
+void GameInstance::prefetch_next_level()
+{
+    int next = this->level + 1;
+    if (this->level == featureLevel || next > levels().get_count() || this->prefetch_level == next) return;
+    this->prefetch = QtConcurrent::run(&GameInstance::prepare_level, next);
+    this->prefetch_level = next;
 }
 
 
 GameInstance::~GameInstance()
 {
+    // The workers still read hint_engine and the levels
+    this->hint_watcher.waitForFinished();
+    this->prefetch.waitForFinished();
     delete this->game_gui;
-    for (int x = 0; x < this->MAP_SIZE; ++x) {
-        for (int y = 0; y < this->MAP_SIZE; ++y) {
-            delete this->blocks[y][x];
-        }
-    }
 }
 
 void GameInstance::block_pressed(int y, int x)
 {
+    PIPES_TRACE_SCOPE("GameInstance::block_pressed");
     if (this->isChecking) return;
-    if (this->blocks[y][x]->get_type() == BlockType::EMPTY) return;
-    this->blocks[y][x]->rotate();
+    if (this->board.get_type(y, x) == BlockType::EMPTY) return;
+    this->board.rotate(y, x);
+    this->history.add_rotation(y, x);
+    this->recording.add_rotation(y, x, this->event_delay());
+    this->flow.changed(y, x);
+    this->refresh_block(y, x);
+    this->refresh_flow();
     ++used_step;
     this->game_gui->set_lcd(GameWindow::USED_STEP_LCD, this->used_step);
+    this->refresh_hint();
 }
 
-int GameInstance::get_result()
+uint32_t GameInstance::event_delay()
 {
-    return this->result;
+    qint64 now = this->clock.elapsed();
+    uint32_t delay = static_cast<uint32_t>(now - this->last_event);
+    this->last_event = now;
+    return delay;
 }
 
-// BFS
-bool** GameInstance::initTravelled() {
-    bool **travelled = new bool* [this->MAP_SIZE];
-    for (int i = 0; i < this->MAP_SIZE; ++i) {
-        travelled[i] = new bool [this->MAP_SIZE];
-        for (int j = 0; j < this->MAP_SIZE; ++j) {
-            travelled[i][j] = false;
+void GameInstance::undo()
+{
+    int block;
+    if (this->isChecking || !this->history.undo(this->board, &block)) return;
+    this->recording.add_undo(this->event_delay());
+    this->history_changed(block, -1);
+}
+
+void GameInstance::redo()
+{
+    int block;
+    if (this->isChecking || !this->history.redo(this->board, &block)) return;
+    this->recording.add_redo(this->event_delay());
+    this->history_changed(block, 1);
+}
+
+// Show the board after undo or redo. Taking back a rotation takes back its step.
+void GameInstance::history_changed(int block, int stepChange)
+{
+    if (block == History::ALL_BLOCKS) {
+        this->flow.reset();
+        for (int y = 0; y < this->board.get_height(); ++y) {
+            for (int x = 0; x < this->board.get_width(); ++x) {
+                this->refresh_block(y, x);
+            }
         }
+    } else {
+        int y = block / this->board.get_width();
+        int x = block % this->board.get_width();
+        this->flow.changed(y, x);
+        this->refresh_block(y, x);
+        this->used_step += stepChange;
+        this->game_gui->set_lcd(GameWindow::USED_STEP_LCD, this->used_step);
     }
-    return travelled;
+    this->refresh_flow();
+    this->refresh_hint();
 }
 
-void GameInstance::deleteTravelled(bool** &travelled) {
-    for (int i = 0; i < this->MAP_SIZE; ++i) {
-        delete [] travelled[i];
+void GameInstance::save_recording()
+{
+    if (this->recording.get_event_count() == 0) return;
+    QDir().mkpath(this->recording_dir);
+    QString name = QString("%1-level%2.pipesrec")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz")).arg(this->level);
+    QString path = this->recording_dir + "/" + name;
+    if (!this->recording.save(QFile::encodeName(path).toStdString())) {
+        qWarning("%s: can not save the recording", qPrintable(path));
     }
-    delete [] travelled;
-    travelled = nullptr;
 }
 
-inline int GameInstance::opposite(int direction) {
-    direction <<= 2;
-    direction |= direction / (1 << 4);
-    direction %= 1 << 4;
-    return direction;
+int GameInstance::get_result()
+{
+    return this->result;
 }
 
-inline int GameInstance::deltaY(int direction) {
-    if (direction & (LEFT | RIGHT)) return 0;
-    if (direction & UP) return -1;
-    if (direction & DOWN) return 1;
-    return 0;
+void GameInstance::refresh_block(int y, int x)
+{
+    this->view->set_block(y, x, this->board.get_type(y, x), this->board.get_orientation(y, x));
+    this->view->set_highlighted(y, x, this->flow.is_wet(y, x));
 }
 
-inline int GameInstance::deltaX(int direction) {
-    if (direction & (UP | DOWN)) return 0;
-    if (direction & LEFT) return -1;
-    if (direction & RIGHT) return 1;
-    return 0;
-}
+// Show the live water state after blocks changed
+void GameInstance::refresh_flow()
+{
+    vector<int> changed = this->flow.take_changed();
+    const int width = this->board.get_width();
+    for (size_t i = 0; i < changed.size(); ++i) {
+        this->updateBlockImage(changed[i] / width, changed[i] % width,
+                               this->flow.is_wet(changed[i] / width, changed[i] % width));
+    }
 
+    BFSStatus status = this->flow.get_status();
+    this->game_gui->set_outlet(status == BFSStatus::CONNECTED);
+    switch (status) {
+    case BFSStatus::CONNECTED:
+        this->game_gui->set_flow_text("Water reaches the outlet."); break;
+    case BFSStatus::LEAKAGE:
+        this->game_gui->set_flow_text("Water is leaking."); break;
+    case BFSStatus::STUCK:
+        this->game_gui->set_flow_text("Water can not reach the outlet.");
+    }
+}
 
+// BFS
 BFSResult GameInstance::bfsBlocks(bool animate) {
-    bool **travelled = this->initTravelled();
-    BFSStatus status = BFSStatus::STUCK;
-    queue<BFSNode> frontier;
-    // initial frontier
-    frontier.push({LEFT, 0, 0});
-
-    int cycle = 1;
-    while (!frontier.empty()) {
-        BFSNode node = frontier.front();
-        frontier.pop();
-
-        // outlet position
-        if (node.x == this->MAP_SIZE && node.y == this->MAP_SIZE - 1) {
-            status = BFSStatus::CONNECTED;
-            continue;
-        }
-
-        // Check range
-        if (node.x < 0 || node.y < 0 || node.x >= this->MAP_SIZE || node.y >= this->MAP_SIZE) {
-            status = BFSStatus::LEAKAGE;
-            break;
-        }
-
-        Block *block = this->blocks[node.y][node.x];
-        int blockDirection = block->get_direction();
-
-        // Cannot flow from
-        if ((node.from & blockDirection) == 0) {
-            status = BFSStatus::LEAKAGE;
-            break;
-        }
-        blockDirection -= node.from;
-
-        // Check travelled
-        if (travelled[node.y][node.x]) {
-            continue;
-        }
-
-        travelled[node.y][node.x] = true;
-
-        if (animate) {
-            QTimer *timer = new QTimer(this);
-            connect(timer, &QTimer::timeout, [=]() {
-                this->updateBlockImage(node.y, node.x, true);
-                delete timer;
-            });
-            timer->start(this->animateTime * cycle);
-        }
-
-        for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
-            if (direction & blockDirection) {
-                frontier.push({this->opposite(direction), node.y + this->deltaY(direction), node.x + this->deltaX(direction)});
+    PIPES_TRACE_SCOPE("GameInstance::bfsBlocks");
+    vector<int> layers;
+    BFSResult result = evaluate(this->board, animate ? &layers : nullptr);
+
+    if (animate) {
+        // Replay the flow from a dry board
+        for (int y = 0; y < this->board.get_height(); ++y) {
+            for (int x = 0; x < this->board.get_width(); ++x) {
+                this->updateBlockImage(y, x, false);
             }
         }
-
-        ++cycle;
+        this->animation->start(layers, this->board.get_width(), this->animateTime, this->animateTime * result.cycles);
     }
 
-    this->deleteTravelled(travelled);
-    return {status, cycle};
+    return result;
 }
 
 void GameInstance::updateBlockImage(int y, int x, bool highlighted) {
-    this->blocks[y][x]->set_highlighted(highlighted);
-    this->blocks[y][x]->updateImage();
+    this->view->set_highlighted(y, x, highlighted);
 }
 
 void GameInstance::on_done_button_clicked()
@@ -212,45 +355,68 @@ void GameInstance::on_done_button_clicked()
     if (this->isChecking) return;
     this->isChecking = true;
     BFSResult result = this->bfsBlocks(this->animationChangeEnabled);
+    if (result.status == BFSStatus::CONNECTED) {
+        if (!this->animationChangeEnabled) {
+            this->bfsBlocks(true);
+        }
+        this->result = this->used_step;
+        this->prefetch_next_level();
+    }
+    this->checkedStatus = result.status;
 
-    QTimer *timer = new QTimer(this);
-    switch (result.status) {
+    // The dialog follows the animation, or shows at once when nothing is animated
+    if (!this->animation->is_running()) {
+        this->show_result();
+    }
+}
+
+void GameInstance::show_result()
+{
+    QString text;
+    switch (this->checkedStatus) {
     case BFSStatus::LEAKAGE:
-        connect(timer, &QTimer::timeout, [=]() {
-            QMessageBox::information(nullptr, "", "There's leakage in the maze.\nGame Over!");
-            this->isChecking = false;
-            this->game_gui->close();
-            delete timer;
-        });
+        text = "There's leakage in the maze.\nGame Over!";
         break;
     case BFSStatus::STUCK:
-        connect(timer, &QTimer::timeout, [=]() {
-            QMessageBox::information(nullptr, "", "It seems the water can not flow into the outlet.\nGame Over!");
-            this->isChecking = false;
-            this->game_gui->close();
-            delete timer;
-        });
+        text = "It seems the water can not flow into the outlet.\nGame Over!";
         break;
     case BFSStatus::CONNECTED:
-        if (!this->animationChangeEnabled) {
-            this->bfsBlocks(true);
+        this->game_gui->set_outlet(true);
+        if (this->optimal_step == -1) {
+            text = "Congratulations!";
+        } else {
+            text = QString("Congratulations!\nYou used %1 steps, the optimum is %2.")
+                .arg(this->used_step).arg(this->optimal_step);
         }
-        this->result = this->used_step;
-        connect(timer, &QTimer::timeout, [=]() {
-            this->game_gui->set_outlet(true);
-            QMessageBox::information(nullptr, "", "Congratulations!");
-            this->isChecking = false;
-            this->game_gui->close();
-            delete timer;
-        });
     }
-    timer->start((this->animationChangeEnabled || result.status == BFSStatus::CONNECTED ? this->animateTime : 0) * result.cycles);
 
+    QMessageBox box(QMessageBox::Information, "", text, QMessageBox::NoButton, this->game_gui);
+    QPushButton *next = nullptr;
+    if (this->checkedStatus == BFSStatus::CONNECTED && this->level != featureLevel
+            && this->level < levels().get_count()) {
+        next = box.addButton("Next level", QMessageBox::AcceptRole);
+    }
+    QPushButton *retry = box.addButton("Retry", QMessageBox::ActionRole);
+    box.addButton("Close", QMessageBox::RejectRole);
+    box.exec();
+    this->isChecking = false;
+
+    // The window stays open for another game
+    if (box.clickedButton() == next && next != nullptr) {
+        this->follow_up = NEXT_LEVEL;
+        this->quit();
+    } else if (box.clickedButton() == retry) {
+        this->follow_up = RETRY;
+        this->quit();
+    } else {
+        this->game_gui->close();
+    }
 }
 
 
 // Feature
 void GameInstance::loadFeatureMap() {
+    this->resize_board(this->MAP_SIZE, this->MAP_SIZE);
     for (int y = 0; y < this->MAP_SIZE; ++y) {
         for (int x = 0; x < this->MAP_SIZE; ++x) {
             this->init_block(BlockType::EMPTY, 0, y, x);
@@ -262,172 +428,114 @@ void GameInstance::loadFeatureMap() {
 }
 
 void GameInstance::randomAddPipe() {
-    Block **emptyBlocks = new Block*[this->MAP_SIZE * this->MAP_SIZE];
-    int size = 0;
-    for (int y = 0; y < this->MAP_SIZE; ++y) {
-        for (int x = 0; x < this->MAP_SIZE; ++x) {
-            if (this->blocks[y][x]->get_type() == BlockType::EMPTY) {
-                emptyBlocks[size++] = this->blocks[y][x];
-            }
-        }
-    }
-    if (size == 0) return;
-    int index = qrand() % size;
-    BlockType type = static_cast<BlockType>(qrand() % 2 + 2);
-    int orientation = qrand() % 4;
+    PIPES_TRACE_SCOPE("GameInstance::randomAddPipe");
+    int index = addRandomPipe(this->board, this->random);
+    if (index < 0) return;
 
-    emptyBlocks[index]->setProperties(type, orientation);
-    emptyBlocks[index]->updateImage();
+    int y = index / this->board.get_width();
+    int x = index % this->board.get_width();
+    this->flow.changed(y, x);
+    this->refresh_block(y, x);
+    this->refresh_flow();
 
 }
 
-BlockData** GameInstance::initBlockData() {
-    BlockData **blockData = new BlockData* [this->MAP_SIZE];
-    for (int y = 0; y < this->MAP_SIZE; ++y) {
-        blockData[y] = new BlockData [this->MAP_SIZE];
-        for (int x = 0; x < this->MAP_SIZE; ++x) {
-            Block* block = this->blocks[y][x];
-            blockData[y][x] = {block->get_type(), block->get_orientation()};
+void GameInstance::replace() {
+    this->flow.reset();
+    for (int y = 0; y < this->board.get_height(); ++y) {
+        for (int x = 0; x < this->board.get_width(); ++x) {
+            this->refresh_block(y, x);
         }
     }
-    return blockData;
+    this->randomAddPipe();
+    this->refresh_hint();
 }
 
-void GameInstance::deleteBlockData(BlockData** &blockData) {
-    for (int y = 0; y < this->MAP_SIZE; ++y) {
-        delete [] blockData[y];
+void GameInstance::keyPressed(QKeyEvent *keyEvent) {
+    PIPES_TRACE_SCOPE("GameInstance::keyPressed");
+    bool control = keyEvent->modifiers().testFlag(Qt::ControlModifier);
+    if (keyEvent->matches(QKeySequence::Undo)) {
+        this->undo();
+        return;
     }
-    delete [] blockData;
-    blockData = nullptr;
-}
-
-void GameInstance::combine(BlockData &destination, BlockData &part) {
-    if (destination.type != part.type) return;
-    switch (destination.type) {
-    case BlockType::EMPTY:
-    case BlockType::TURN:
+    if (keyEvent->matches(QKeySequence::Redo) || (control && keyEvent->key() == Qt::Key::Key_Y)) {
+        this->redo();
         return;
-    case BlockType::CROSS:
-        destination.type = BlockType::TJUNCTION;
-        break;
-    case BlockType::TJUNCTION:
-        destination.type = BlockType::STRAIGHT;
-        break;
-    case BlockType::STRAIGHT:
-        destination.type = BlockType::TURN;
-        break;
     }
-    part.type = BlockType::EMPTY;
-}
-
-void GameInstance::rotateClockwise(BlockData** blockData) {
-    const int size = this->MAP_SIZE;
-    BlockData **result = this->initBlockData();
+    if (this->level != featureLevel) return;
 
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[j][size - i - 1] = blockData[i][j];
-        }
-    }
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            blockData[i][j] = result[i][j];
-        }
+    SwipeDirection direction;
+    switch (keyEvent->key()) {
+    case Qt::Key::Key_Left:
+        direction = SWIPE_LEFT; break;
+    case Qt::Key::Key_Right:
+        direction = SWIPE_RIGHT; break;
+    case Qt::Key::Key_Up:
+        direction = SWIPE_UP; break;
+    case Qt::Key::Key_Down:
+        direction = SWIPE_DOWN; break;
+    default:
+        return;
     }
-    this->deleteBlockData(result);
+    this->history.add_snapshot(this->board);
+    swipe(this->board, direction);
+    this->recording.add_swipe(direction, this->event_delay());
+    this->replace();
 }
 
-void GameInstance::swipeLeft(BlockData** blockData) {
-    const int size = this->MAP_SIZE;
-    for (int y = 0; y < size; ++y) {
-        BlockType leftType = BlockType::EMPTY;
-        int leftIndex = -1;
-        for (int x = 0; x < size; ++x) {
-            if (blockData[y][x].type == BlockType::EMPTY) {
-                continue;
-            }
-            if (leftType == BlockType::EMPTY || blockData[y][x].type != leftType) {
-                leftType = blockData[y][x].type;
-                leftIndex = x;
-            } else {
-                combine(blockData[y][leftIndex], blockData[y][x]);
-                leftType = BlockType::EMPTY;
-                leftIndex = -1;
-            }
-        }
-
-        int count = 0;
-        for (int x = 0; x < size; ++x) {
-            if (blockData[y][x].type != BlockType::EMPTY) {
-                blockData[y][count++] = blockData[y][x];
-            }
-        }
-        for (; count < size; ++count) {
-            blockData[y][count] = {BlockType::EMPTY, 0};
-        }
+// Hint
+void GameInstance::start_hint()
+{
+    if (this->hint_watcher.isRunning()) {
+        this->hint_stale = true;
+        return;
     }
+    Board snapshot = this->board;
+    this->hint_watcher.setFuture(QtConcurrent::run([this, snapshot]() {
+        return this->hint_engine.hint(snapshot);
+    }));
 }
 
-
-void GameInstance::swipeRight(BlockData** blockData) {
-    this->rotateClockwise(blockData);
-    this->rotateClockwise(blockData);
-    this->swipeLeft(blockData);
-    this->rotateClockwise(blockData);
-    this->rotateClockwise(blockData);
+// The board changed under a visible hint
+void GameInstance::refresh_hint()
+{
+    if (!this->hint_wanted) return;
+    this->view->set_hint(-1, -1);
+    this->start_hint();
 }
 
-
-void GameInstance::swipeUp(BlockData** blockData) {
-    this->rotateClockwise(blockData);
-    this->rotateClockwise(blockData);
-    this->rotateClockwise(blockData);
-    this->swipeLeft(blockData);
-    this->rotateClockwise(blockData);
+void GameInstance::request_hint()
+{
+    if (this->isChecking) return;
+    this->hint_wanted = true;
+    this->start_hint();
 }
 
-
-void GameInstance::swipeDown(BlockData** blockData) {
-    this->rotateClockwise(blockData);
-    this->swipeLeft(blockData);
-    this->rotateClockwise(blockData);
-    this->rotateClockwise(blockData);
-    this->rotateClockwise(blockData);
+void GameInstance::dismiss_hint()
+{
+    if (!this->hint_wanted) return;
+    this->hint_wanted = false;
+    this->view->set_hint(-1, -1);
+    this->refresh_flow();
 }
 
-void GameInstance::replace(BlockData** blockData) {
-    for (int y = 0; y < this->MAP_SIZE; ++y) {
-        for (int x = 0; x < this->MAP_SIZE; ++x) {
-            this->blocks[y][x]->setProperties(blockData[y][x].type, blockData[y][x].orientation);
-            this->blocks[y][x]->updateImage();
-        }
+void GameInstance::show_hint()
+{
+    if (this->hint_stale) {
+        this->hint_stale = false;
+        if (this->hint_wanted) this->start_hint();
+        return;
     }
-    this->randomAddPipe();
-
-}
-
-void GameInstance::keyPressed(QKeyEvent *keyEvent) {
-    BlockData **blockData = this->initBlockData();
-    switch (keyEvent->key()) {
-    case Qt::Key::Key_Left:
-        this->swipeLeft(blockData);
-        this->replace(blockData); break;
-    case Qt::Key::Key_Right:
-        this->swipeRight(blockData);
-        this->replace(blockData); break;
-    case Qt::Key::Key_Up:
-        this->swipeUp(blockData);
-        this->replace(blockData); break;
-    case Qt::Key::Key_Down:
-        this->swipeDown(blockData);
-        this->replace(blockData); break;
+    if (!this->hint_wanted || this->isChecking) return;
+
+    Hint hint = this->hint_watcher.result();
+    if (!hint.solvable) {
+        this->game_gui->set_flow_text("No rotations can connect this board.");
+    } else if (hint.remaining == 0) {
+        this->game_gui->set_flow_text("Water reaches the outlet.");
+    } else {
+        this->view->set_hint(hint.y, hint.x);
+        this->game_gui->set_flow_text(QString("Rotate row %1, column %2 %3 time(s). %4 clicks to the optimum.")
+                                      .arg(hint.y + 1).arg(hint.x + 1).arg(hint.clicks).arg(hint.remaining));
     }
-
-    this->deleteBlockData(blockData);
 }
-
-
-
-
-
-
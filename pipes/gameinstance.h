@@ -1,86 +1,132 @@
 #ifndef GAMEINSTANCE_H
 #define GAMEINSTANCE_H
 
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <QString>
 #include <QObject>
 
-#include "block.h"
+#include "boardview.h"
+#include "board.h"
+#include "evaluator.h"
+#include "flowanimation.h"
+#include "hint.h"
+#include "history.h"
+#include "levelsource.h"
+#include "liveflow.h"
+#include "random.h"
+#include "recording.h"
 
 class GameWindow;
 
-struct BFSNode {
-    int from, y, x;
-};
-
-enum BFSStatus {
-    CONNECTED, LEAKAGE, STUCK
-};
-
-struct BFSResult {
-    BFSStatus status;
-    int cycles;
-};
-
-struct BlockData {
-    BlockType type;
-    int orientation;
+// A level ready to play: its board at the level's own size and the optimum
+struct PreparedLevel {
+    int level;
+    Board board;
+    int optimal_step;
 };
 
+// One game window, reused for every game. start() resets the board, the
+// counters and the window in place, so a retry or the next level costs no
+// more than rewriting the blocks that differ.
 class GameInstance : public QObject
 {
     Q_OBJECT
 
  public:
-    GameInstance(int _level, int _min_step);
+    // What the player chose when the game ended
+    enum FollowUp {CLOSE, RETRY, NEXT_LEVEL};
+
+    GameInstance();
     ~GameInstance();
-    void block_pressed(int y, int x);
+    void start(int _level, int _min_step);
+    int get_level();
     int get_result();
+    FollowUp get_follow_up();
+    static const LevelSource &levels();
+    // Safe on any thread once levels() has been called
+    static PreparedLevel prepare_level(int level);
 
  private:
 
     static const QString map_path;
-    static const int MAP_SIZE = 8;
-    Block *blocks[MAP_SIZE][MAP_SIZE];
+    static const QString pack_name;
+    static const QString recording_dir;
+    static const int MAP_SIZE = Board::DEFAULT_SIZE;
+    Board board;
+    LiveFlow flow;
     GameWindow *game_gui;
+    BoardView *view;
     int used_step;
     int min_step;
+    int optimal_step;
     int level;
     int result;
+    FollowUp follow_up;
     void init_block(int _type, int _orientation, int _y, int _x);
     void load_map(int dest_level);
+    void load_prepared(const PreparedLevel &prepared);
+    void resize_board(int height, int width);
+
+    // The next level is prepared while the win animation plays
+    QFuture<PreparedLevel> prefetch;
+    int prefetch_level = 0;
+    void prefetch_next_level();
+    void refresh_block(int y, int x);
+    void refresh_flow();
+
+    // Every game is recorded and saved when its window closes
+    Random random;
+    Recording recording;
+    QElapsedTimer clock;
+    qint64 last_event;
+    uint32_t event_delay();
+    void save_recording();
+
+    // Ctrl+Z and Ctrl+Y, in both modes
+    History history;
+    void undo();
+    void redo();
+    void history_changed(int block, int stepChange);
 
     // BFS
     bool isChecking = false;
     static const int animateTime = 100;
-    bool** initTravelled();
-    void deleteTravelled(bool** &travelled);
-    inline int opposite(int direction);
-    inline int deltaY(int direction);
-    inline int deltaX(int direction);
+    FlowAnimation *animation;
+    BFSStatus checkedStatus;
     void updateBlockImage(int y, int x, bool highlighted);
     BFSResult bfsBlocks(bool animate = false);
 
+    // Hints are worked out off the UI thread, one at a time; a hint for an
+    // outdated board is dropped and asked for again
+    HintEngine hint_engine;
+    QFutureWatcher<Hint> hint_watcher;
+    bool hint_wanted = false;
+    bool hint_stale = false;
+    void start_hint();
+    void refresh_hint();
+
     // Feature added
     static const bool animationChangeEnabled = true;
     void loadFeatureMap();
     void randomAddPipe();
-    BlockData** initBlockData();
-    void deleteBlockData(BlockData** &blockData);
-    void replace(BlockData** blockData);
-    void combine(BlockData &destination, BlockData &part);
-    void rotateClockwise(BlockData** blockData);
-    void swipeLeft(BlockData** blockData);
-    void swipeRight(BlockData** blockData);
-    void swipeUp(BlockData** blockData) ;
-    void swipeDown(BlockData** blockData);
+    void replace();
 
  signals:
     void game_over();
 
+ public slots:
+    void block_pressed(int y, int x);
+
  private slots:
     void on_done_button_clicked();
+    void show_result();
     void quit();
     void keyPressed(QKeyEvent *keyEvent);
+    void request_hint();
+    void dismiss_hint();
+    void show_hint();
 };
 
 #endif // GAMEINSTANCE_H
@@ -7,13 +7,25 @@
 
 #include "gamewindow.h"
 #include "ui_gamewindow.h"
+#include "trace.h"
 
 GameWindow::GameWindow(QWidget *parent):
     QWidget(parent),
-    ui(new Ui::GameWindow)
+    ui(new Ui::GameWindow),
+    outlet_filled(false)
 {
     ui -> setupUi(this);
-    show();
+    board_view = new BoardView(this);
+    ui -> hint_button -> installEventFilter(this);
+    connect(ui -> hint_button, SIGNAL(clicked()), this, SIGNAL(hintRequested()));
+#if defined(PIPES_TRACING)
+    trace_overlay = new QLabel(this);
+    trace_overlay -> setStyleSheet("background-color: rgba(0, 0, 0, 160); color: white; font-family: monospace; padding: 4px;");
+    trace_overlay -> move(10, 10);
+    trace_overlay -> hide();
+    trace_timer.setInterval(500);
+    connect(&trace_timer, SIGNAL(timeout()), this, SLOT(refresh_trace_overlay()));
+#endif
 }
 
 GameWindow::~GameWindow()
@@ -23,6 +35,7 @@ GameWindow::~GameWindow()
 
 void GameWindow::paintEvent(QPaintEvent *event)
 {
+    PIPES_TRACE_SCOPE("GameWindow::paintEvent");
     QStyleOption opt;
     opt.init(this);
     QPainter p(this);
@@ -31,6 +44,9 @@ void GameWindow::paintEvent(QPaintEvent *event)
 
 void GameWindow::set_outlet(bool condition)
 {
+    // Avoid restyling the label on every click
+    if (condition == outlet_filled) return;
+    outlet_filled = condition;
     if (condition) {
         ui -> outlet -> setStyleSheet("border-image: url(\":/resources/images/outlet_f.png\");");
     } else {
@@ -38,6 +54,11 @@ void GameWindow::set_outlet(bool condition)
     }
 }
 
+void GameWindow::set_flow_text(const QString &text)
+{
+    ui -> flow_label -> setText(text);
+}
+
 void GameWindow::set_lcd(int type, int value)
 {
     QLCDNumber *lcds[3] = {ui -> steps_lcd, ui -> minstep_lcd, ui -> level_lcd};
@@ -50,13 +71,58 @@ QPushButton* GameWindow::get_done_button()
     return ui -> done_button;
 }
 
+BoardView* GameWindow::get_board_view()
+{
+    return board_view;
+}
+
 void GameWindow::closeEvent(QCloseEvent *event)
 {
     emit closed();
     event -> accept();
 }
 
+bool GameWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui -> hint_button) {
+        if (event -> type() == QEvent::Enter) emit hintRequested();
+        if (event -> type() == QEvent::Leave) emit hintDismissed();
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
 void GameWindow::keyPressEvent(QKeyEvent *keyEvent){
+#if defined(PIPES_TRACING)
+    if (keyEvent -> key() == Qt::Key_F3) {
+        if (trace_overlay -> isVisible()) {
+            trace_timer.stop();
+            trace_overlay -> hide();
+        } else {
+            refresh_trace_overlay();
+            trace_overlay -> show();
+            trace_overlay -> raise();
+            trace_timer.start();
+        }
+        return;
+    }
+#endif
     emit keyPressed(keyEvent);
 }
 
+#if defined(PIPES_TRACING)
+void GameWindow::refresh_trace_overlay()
+{
+    static const char *names[] = {"BoardView::paintEvent", "evaluate", "GameInstance::block_pressed"};
+    static const char *labels[] = {"frame", "eval ", "click"};
+    QString text = "        p50      p90      p99      max  (ms)";
+    for (int i = 0; i < 3; ++i) {
+        TraceStats stats = Trace::stats(names[i]);
+        text += QString("\n%1 %2 %3 %4 %5").arg(labels[i])
+            .arg(stats.p50 / 1000, 8, 'f', 3).arg(stats.p90 / 1000, 8, 'f', 3)
+            .arg(stats.p99 / 1000, 8, 'f', 3).arg(stats.max / 1000, 8, 'f', 3);
+    }
+    trace_overlay -> setText(text);
+    trace_overlay -> adjustSize();
+}
+#endif
+
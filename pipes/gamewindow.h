@@ -2,6 +2,10 @@
 #define GAMEWINDOW_H
 
 #include <QDialog>
+#include <QLabel>
+#include <QTimer>
+
+#include "boardview.h"
 
 namespace Ui
 {
@@ -20,19 +24,38 @@ class GameWindow : public QWidget
     ~GameWindow();
     void set_lcd(int type, int value);
     void set_outlet(bool condition);
+    void set_flow_text(const QString &text);
     QPushButton* get_done_button();
+    BoardView* get_board_view();
 
  private:
     Ui::GameWindow *ui;
+    BoardView *board_view;
+    bool outlet_filled;
     void keyPressEvent(QKeyEvent *keyEvent);
+    bool eventFilter(QObject *watched, QEvent *event);
+
+#if defined(PIPES_TRACING)
+    // F3 shows the latest timings over the board
+    QLabel *trace_overlay;
+    QTimer trace_timer;
+#endif
 
  protected:
     void paintEvent(QPaintEvent *event);
     void closeEvent(QCloseEvent *event);
 
+#if defined(PIPES_TRACING)
+ private slots:
+    void refresh_trace_overlay();
+#endif
+
  signals:
     void closed();
     void keyPressed(QKeyEvent *keyEvent);
+    // Hovering or clicking the hint button asks for a hint, leaving it hides it
+    void hintRequested();
+    void hintDismissed();
 };
 
 #endif // GAMEWINDOW_H
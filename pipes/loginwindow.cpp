@@ -1,47 +1,175 @@
 #include "loginwindow.h"
 #include "gameinstance.h"
 #include "recordmanager.h"
+#include "startuptimer.h"
 #include "ui_loginwindow.h"
+#include <QApplication>
+#include <QComboBox>
 #include <QMessageBox>
-#include <QTime>
+#include <QPaintEvent>
+#include <QPalette>
+#include <QRegularExpressionValidator>
+#include <QTimer>
+#include <QtConcurrent>
 
-#include <sstream>
-
-using std::ostringstream;
 
 LoginWindow::LoginWindow(QWidget *parent):
     QMainWindow(parent),
     ui(new Ui::LoginWindow),
-    rm(new RecordManager()),
+    game(nullptr),
+    rm(nullptr),
     current_level(1),
-    started(false)
+    started(false),
+    startedFeature(false),
+    profile_box(new QComboBox(this)),
+    background_loading(-1),
+    first_frame_seen(false),
+    deferred_loaded(false)
 {
     ui -> setupUi(this);
-    qsrand(static_cast<uint>(QTime::currentTime().msec()));
+    ui -> centralWidget -> installEventFilter(this);
+    connect(&background_watcher, SIGNAL(finished()), this, SLOT(background_loaded()));
+    refresh_background();
+
+    // Profile names become file names
+    profile_box -> setEditable(true);
+    profile_box -> setInsertPolicy(QComboBox::InsertAlphabetically);
+    profile_box -> setValidator(new QRegularExpressionValidator(QRegularExpression("[A-Za-z0-9_-]{1,32}"), profile_box));
+    profile_box -> addItem(RecordManager::default_profile);
+    ui -> statusBar -> addPermanentWidget(profile_box);
+    connect(profile_box, SIGNAL(currentIndexChanged(int)), this, SLOT(profile_changed(int)));
 }
 
 LoginWindow::~LoginWindow()
 {
+    background_watcher.waitForFinished();
+    delete game;
     delete rm;
     delete ui;
 }
 
+RecordManager *LoginWindow::records()
+{
+    if (rm == nullptr) rm = new RecordManager();
+    return rm;
+}
+
+void LoginWindow::refresh_profiles()
+{
+    profile_box -> blockSignals(true);
+    profile_box -> clear();
+    profile_box -> addItems(RecordManager::get_profiles());
+    profile_box -> setCurrentText(records() -> get_profile());
+    profile_box -> blockSignals(false);
+}
+
+// Records, and the levels they unlock, belong to the chosen profile
+void LoginWindow::profile_changed(int index)
+{
+    QString profile = profile_box -> itemText(index);
+    if (profile.isEmpty() || (rm != nullptr && rm -> get_profile() == profile)) return;
+    delete rm;
+    rm = new RecordManager(profile);
+    current_level = 1;
+    refresh_background();
+    set_statusbar_text("Playing as " + profile.toStdString() + ".");
+}
+
+bool LoginWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    // The frame is on screen once the paint has been handled
+    if (watched == ui -> centralWidget && event -> type() == QEvent::Paint && !first_frame_seen) {
+        first_frame_seen = true;
+        QTimer::singleShot(0, this, SLOT(first_frame()));
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+// Whatever the first frame did not need
+void LoginWindow::first_frame()
+{
+    StartupTimer::mark("first frame");
+    records();
+    refresh_profiles();
+    StartupTimer::mark("records");
+    GameInstance::levels();
+    StartupTimer::mark("levels");
+    deferred_loaded = true;
+    finish_benchmark();
+}
+
+// The benchmark ends once the background is shown and nothing is left deferred
+void LoginWindow::finish_benchmark()
+{
+    if (StartupTimer::is_benchmark() && deferred_loaded && backgrounds.contains(background_index(current_level))) {
+        StartupTimer::report();
+        qApp -> quit();
+    }
+}
+
 void LoginWindow::set_statusbar_text(string str)
 {
     ui -> statusBar -> showMessage(QString::fromStdString(str));
 }
 
+// The pictures repeat after the tenth level
+int LoginWindow::background_index(int level) const
+{
+    return (level - 1) % BACKGROUNDS + 1;
+}
+
+static QImage decodeBackground(const QString &path, const QSize &size)
+{
+    return QImage(path).scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+void LoginWindow::load_background(int index)
+{
+    if (background_watcher.isRunning()) return;
+    background_loading = index;
+    QString path = QString(":/resources/images/login_pic/level_%1.png").arg(index);
+    background_watcher.setFuture(QtConcurrent::run(decodeBackground, path, ui -> centralWidget -> maximumSize()));
+}
+
 void LoginWindow::refresh_background()
 {
-    ostringstream buf;
-    buf << "#centralWidget { border-image: url(\":/resources/images/login_pic/level_" << current_level << ".png\"); }";
-    ui -> centralWidget -> setStyleSheet(QString::fromStdString(buf.str()));
+    int index = background_index(current_level);
+    if (!backgrounds.contains(index)) {
+        // Shown when it arrives
+        load_background(index);
+        return;
+    }
+    QPixmap pixmap = backgrounds[index];
+    if (pixmap.size() != ui -> centralWidget -> size()) {
+        pixmap = pixmap.scaled(ui -> centralWidget -> size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    QPalette palette = ui -> centralWidget -> palette();
+    palette.setBrush(QPalette::Window, QBrush(pixmap));
+    ui -> centralWidget -> setPalette(palette);
+    ui -> centralWidget -> setAutoFillBackground(true);
+
+    int next = background_index(current_level + 1);
+    if (!backgrounds.contains(next)) load_background(next);
+}
+
+void LoginWindow::background_loaded()
+{
+    backgrounds[background_loading] = QPixmap::fromImage(background_watcher.result());
+    if (backgrounds.size() == 1) StartupTimer::mark("background");
+    refresh_background();
+    finish_benchmark();
 }
 
-void LoginWindow::start_game()
+void LoginWindow::start_game(int level)
 {
-    game = new GameInstance(current_level, rm -> get_record(current_level));
-    connect(game, SIGNAL(game_over()), this, SLOT(game_closed()));
+    if (game == nullptr) {
+        game = new GameInstance();
+        connect(game, SIGNAL(game_over()), this, SLOT(game_closed()));
+    }
+    game -> start(level, records() -> get_record(level));
+    profile_box -> setEnabled(false);
+    started = true;
+    startedFeature = level == featureLevel;
 }
 
 void LoginWindow::game_closed()
@@ -49,12 +177,27 @@ void LoginWindow::game_closed()
     // update record if needed
     int minimumStep = this->game->get_result();
     int level = (this->startedFeature ? featureLevel : this->current_level);
-    int previous = rm->get_record(level);
+    int previous = records()->get_record(level);
     if (previous == -1 || (minimumStep != -1 && minimumStep < previous))
-        rm->update_record(level, minimumStep);
+        records()->update_record(level, minimumStep);
 
     this->started = false;
     this->startedFeature = false;
+    this->profile_box->setEnabled(true);
+
+    // Straight into the next game, in the same window
+    switch (this->game->get_follow_up()) {
+    case GameInstance::RETRY:
+        this->start_game(level);
+        break;
+    case GameInstance::NEXT_LEVEL:
+        this->current_level = level + 1;
+        this->refresh_background();
+        this->start_game(this->current_level);
+        break;
+    case GameInstance::CLOSE:
+        break;
+    }
 }
 
 void LoginWindow::on_prev_button_clicked()
@@ -74,11 +217,11 @@ void LoginWindow::on_next_button_clicked()
 {
     if (this->started) return;
 
-    if (this->current_level == this->rm->get_num_of_levels()) {
+    if (this->current_level >= GameInstance::levels().get_count()) {
         this->set_statusbar_text("You are already at the maximum level.");
         return;
     }
-    if (rm->get_record(this->current_level) == -1) {
+    if (records()->get_record(this->current_level) == -1) {
         this->set_statusbar_text("You can not move to next level before passing this level.");
         return;
     }
@@ -92,21 +235,12 @@ void LoginWindow::on_start_button_clicked()
 {
     if (this->started) return;
 
-    this->start_game();
-    this->started = true;
+    this->start_game(this->current_level);
 }
 
 void LoginWindow::on_feature_button_clicked() {
     if (this->started) return;
-    this->start_feature_game();
+    this->start_game(featureLevel);
 
-    this->started = true;
-    this->startedFeature = true;
     QMessageBox::information(nullptr, "New Game Mode", "Using arrow keys to move pipes, like 2048!!");
 }
-
-void LoginWindow::start_feature_game()
-{
-    game = new GameInstance(featureLevel, rm->get_record(featureLevel));
-    connect(game, SIGNAL(game_over()), this, SLOT(game_closed()));
-}
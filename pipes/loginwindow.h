@@ -1,11 +1,16 @@
 #ifndef LOGINWINDOW_H
 #define LOGINWINDOW_H
 
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
 #include <QMainWindow>
+#include <QPixmap>
 
 static const int featureLevel = 20506440;
 
 class GameInstance;
+class QComboBox;
 class RecordManager;
 
 using std::string;
@@ -24,16 +29,34 @@ class LoginWindow : public QMainWindow
     ~LoginWindow();
 
  private:
+    static const int BACKGROUNDS = 10;
     Ui::LoginWindow *ui;
     GameInstance *game;
     RecordManager *rm;
     int current_level;
     bool started;
     bool startedFeature;
-    void start_game();
-    void start_feature_game();
+    // The one game window, created for the first game and reused after
+    void start_game(int level);
     void set_statusbar_text(string str);
+    // Opened on first use, or right after the first frame
+    RecordManager *records();
+    // Lists the profiles on disk; a new name typed in starts a new profile
+    QComboBox *profile_box;
+    void refresh_profiles();
+
+    // Backgrounds are decoded and scaled off the UI thread, the next one ahead
+    QHash<int, QPixmap> backgrounds;
+    QFutureWatcher<QImage> background_watcher;
+    int background_loading;
     void refresh_background();
+    void load_background(int index);
+    int background_index(int level) const;
+
+    bool first_frame_seen;
+    bool deferred_loaded;
+    bool eventFilter(QObject *watched, QEvent *event);
+    void finish_benchmark();
 
  private slots:
     void on_prev_button_clicked();
@@ -41,6 +64,9 @@ class LoginWindow : public QMainWindow
     void on_start_button_clicked();
     void on_feature_button_clicked();
     void game_closed();
+    void background_loaded();
+    void first_frame();
+    void profile_changed(int index);
 };
 
 #endif // LOGINWINDOW_H
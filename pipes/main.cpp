@@ -1,12 +1,31 @@
 #include "loginwindow.h"
+#include "gameinstance.h"
 #include <QApplication>
 #include <QDir>
+#include <QFile>
 #include <QDebug>
 
+#include "startuptimer.h"
+#include "trace.h"
+
 int main(int argc, char *argv[])
 {
+    StartupTimer::mark("main");
     QApplication a(argc, argv);
+    StartupTimer::set_benchmark(a.arguments().contains("--startup-benchmark"));
+    StartupTimer::mark("application");
+    // Levels, records and backgrounds load after the first frame
     LoginWindow w;
+    StartupTimer::mark("window");
     w.show();
-    return a.exec();
+    StartupTimer::mark("shown");
+    int result = a.exec();
+#if defined(PIPES_TRACING)
+    // PIPES_TRACE=trace.json keeps the spans for chrome://tracing or Perfetto
+    QString tracePath = QString::fromLocal8Bit(qgetenv("PIPES_TRACE"));
+    if (!tracePath.isEmpty() && !Trace::dump_json(QFile::encodeName(tracePath).toStdString())) {
+        qWarning("%s: can not write the trace", qPrintable(tracePath));
+    }
+#endif
+    return result;
 }
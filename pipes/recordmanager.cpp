@@ -3,85 +3,83 @@
 #include <QFileInfo>
 #include <QTextStream>
 #include <QStandardPaths>
-#include <QMessageBox>
 
 #include "recordmanager.h"
 #include "loginwindow.h"
+#include "trace.h"
 
-const QString RecordManager::record_dir =
-    QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/comp2012h_pipes";
+const QString RecordManager::default_profile = "default";
+const QString RecordManager::profile_dir =
+    QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/comp2012h_pipes/profiles";
 const QString RecordManager::record_path =
     QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/comp2012h_pipes/record.txt";
 const QString RecordManager::record_path_feature =
     QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/comp2012h_pipes/record_feature.txt";
 
-RecordManager::RecordManager()
+RecordManager::RecordManager(const QString &_profile):
+    profile(_profile)
 {
     // Create directory if not exist
-    if (!QDir(this->record_dir).exists()) {
-        QDir().mkdir(this->record_dir);
+    QDir().mkpath(this->profile_dir);
+
+    QString path = this->profile_dir + "/" + this->profile + ".records";
+    bool exists = QFileInfo::exists(path);
+    this->store.reset(new RecordStore(QFile::encodeName(path).toStdString()));
+    if (!this->store->is_valid()) {
+        qWarning("%s: damaged records, they are replaced on the next update", qPrintable(path));
+    }
+    if (!exists && this->profile == this->default_profile) {
+        this->migrate();
     }
+}
 
+// Records from before profiles, one line per level and a file for the feature
+void RecordManager::migrate()
+{
+    PIPES_TRACE_SCOPE("RecordManager::migrate");
     QFile record{this->record_path};
-    if (!record.exists()) {
-        // File does not exist, write data
-        for (int level = 1; level <= this->NUM_OF_LEVELS; ++level) {
-            this->update_record(level, -1);
-        }
-    } else {
-        // File exist, read data
-        record.open(QIODevice::ReadOnly | QIODevice::Text);
+    if (record.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream{&record};
-        for (int level = 0; level < this->NUM_OF_LEVELS; ++level) {
-            stream >> this->records[level];
+        int value;
+        for (int level = 1; ; ++level) {
+            stream >> value;
+            if (stream.status() != QTextStream::Ok) break;
+            if (value != -1) this->store->update_record(level, value);
         }
     }
-    record.close();
-    // Record for feature
     QFile featureRecord{this->record_path_feature};
-    if (!featureRecord.exists()) {
-        // File does not exist, write data
-        this->update_record(featureLevel, -1);
-    } else {
-        // File exist, read data
-        featureRecord.open(QIODevice::ReadOnly | QIODevice::Text);
+    if (featureRecord.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream stream{&featureRecord};
-        stream >> this->featureRecord;
+        int value = -1;
+        stream >> value;
+        if (stream.status() == QTextStream::Ok && value != -1) this->store->update_record(featureLevel, value);
     }
-    featureRecord.close();
 }
 
 int RecordManager::get_record(int level)
 {
-    if (level == featureLevel) return this->featureRecord;
-    if (level < 1 || level > this->NUM_OF_LEVELS || level > this->MAX_LEVEL) return -1;
-    return this->records[level - 1];
+    if (level < 1) return -1;
+    return this->store->get_record(level);
 }
 
-int RecordManager::get_num_of_levels()
+void RecordManager::update_record(int level, int value)
 {
-    return this->NUM_OF_LEVELS;
+    if (level < 1) return;
+    this->store->update_record(level, value);
 }
 
-void RecordManager::update_record(int level, int value)
+QString RecordManager::get_profile()
 {
-    if (level < 1 || ((level > this->NUM_OF_LEVELS || level > this->MAX_LEVEL) && level != featureLevel)) return;
-
-    QString path = level == featureLevel ? this->record_path_feature : this->record_path;
-    QFile record{path};
-    record.open(QIODevice::WriteOnly | QIODevice::Text);
-    QTextStream stream{&record};
+    return this->profile;
+}
 
-    if (level == featureLevel) {
-        this->featureRecord = value;
-        stream << this->featureRecord << endl;
-    } else {
-        this->records[level - 1] = value;
-        for (int level = 0; level < this->NUM_OF_LEVELS; ++level) {
-            stream << this->records[level] << endl;
-        }
+QStringList RecordManager::get_profiles()
+{
+    QStringList profiles;
+    QStringList files = QDir(profile_dir).entryList(QStringList("*.records"), QDir::Files, QDir::Name);
+    for (int i = 0; i < files.size(); ++i) {
+        profiles << QFileInfo(files[i]).completeBaseName();
     }
-
-    record.close();
+    if (!profiles.contains(default_profile)) profiles.prepend(default_profile);
+    return profiles;
 }
-
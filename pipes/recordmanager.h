@@ -2,23 +2,31 @@
 #define RECORDMANAGER_H
 
 #include <QString>
+#include <QStringList>
+#include <memory>
 
+#include "recordstore.h"
+
+// Records of one player profile. Lookups read the store's pages on demand and
+// updates are written to disk in the background.
 class RecordManager
 {
  public:
-    RecordManager();
+    explicit RecordManager(const QString &_profile = default_profile);
     int get_record(int level);
-    int get_num_of_levels();
     void update_record(int level, int value);
+    QString get_profile();
+    static QStringList get_profiles();
+
+    static const QString default_profile;
 
  private:
-    static const int MAX_LEVEL = 10;
-    static const int NUM_OF_LEVELS = 3;
-    static const QString record_dir;
+    static const QString profile_dir;
     static const QString record_path;
     static const QString record_path_feature;
-    int records[MAX_LEVEL + 1];
-    int featureRecord;
+    QString profile;
+    std::unique_ptr<RecordStore> store;
+    void migrate();
 };
 
 #endif // RECORDMANAGER_H
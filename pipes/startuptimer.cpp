@@ -0,0 +1,51 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "startuptimer.h"
+
+using namespace std;
+
+namespace {
+
+struct Milestone {
+    const char *phase;
+    double time;
+};
+
+const chrono::steady_clock::time_point processStart = chrono::steady_clock::now();
+vector<Milestone> milestones;
+bool benchmark = false;
+
+}
+
+void StartupTimer::mark(const char *phase)
+{
+    Milestone milestone = {phase, elapsed()};
+    milestones.push_back(milestone);
+}
+
+double StartupTimer::elapsed()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - processStart).count();
+}
+
+bool StartupTimer::is_benchmark()
+{
+    return benchmark;
+}
+
+void StartupTimer::set_benchmark(bool value)
+{
+    benchmark = value;
+}
+
+void StartupTimer::report()
+{
+    double previous = 0;
+    for (size_t i = 0; i < milestones.size(); ++i) {
+        fprintf(stderr, "startup %-14s %8.2f ms  (+%.2f)\n", milestones[i].phase, milestones[i].time,
+                milestones[i].time - previous);
+        previous = milestones[i].time;
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+// Milestones of a cold start, in milliseconds since the program's static
+// initialization, which is as close to process start as portable code gets.
+// Run the game with --startup-benchmark to print them and quit once the first
+// frame is on screen; bench/startup.sh repeats that and reports the spread.
+class StartupTimer
+{
+ public:
+    static void mark(const char *phase);
+    static double elapsed();
+    static bool is_benchmark();
+    static void set_benchmark(bool value);
+    // Prints every milestone to stderr
+    static void report();
+};
+
+#endif // STARTUPTIMER_H
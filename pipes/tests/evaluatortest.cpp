@@ -0,0 +1,161 @@
+#include <queue>
+#include <vector>
+
+#include "batchevaluator.h"
+#include "evaluator.h"
+#include "generator.h"
+#include "parallelevaluator.h"
+#include "solver.h"
+#include "test.h"
+
+using namespace std;
+
+// The queue BFS evaluate() started out as: one node per pipe end the water
+// flows through, in order of the step it gets there
+static BFSResult referenceEvaluate(const Board &board, vector<int> &layers) {
+    const int height = board.get_height();
+    const int width = board.get_width();
+    layers.assign(static_cast<size_t>(height) * width, -1);
+    bool leaked = false;
+    bool connected = false;
+    int layerCount = 0;
+    queue<BFSNode> frontier;
+    frontier.push({LEFT, 0, 0, 0});
+    while (!frontier.empty()) {
+        BFSNode node = frontier.front();
+        frontier.pop();
+        if (node.x == width && node.y == height - 1) {
+            connected = true;
+            continue;
+        }
+        if (!board.contains(node.y, node.x)) {
+            leaked = true;
+            continue;
+        }
+        int blockDirection = board.get_direction(node.y, node.x);
+        if ((node.from & blockDirection) == 0) {
+            leaked = true;
+            continue;
+        }
+        int index = node.y * width + node.x;
+        if (layers[index] >= 0) continue;
+        layers[index] = node.layer;
+        layerCount = node.layer + 1;
+        for (int direction = LEFT; direction <= DOWN; direction <<= 1) {
+            if ((direction & blockDirection) && direction != node.from) {
+                frontier.push({oppositeDirection(direction), node.y + deltaY(direction), node.x + deltaX(direction),
+                               node.layer + 1});
+            }
+        }
+    }
+    BFSStatus status = leaked ? BFSStatus::LEAKAGE : connected ? BFSStatus::CONNECTED : BFSStatus::STUCK;
+    return {status, layerCount + 1};
+}
+
+// A generated level turned to its optimum, so the water crosses the board
+static Board solvedBoard(int size, uint64_t seed) {
+    GeneratorOptions options;
+    options.height = size;
+    options.width = size;
+    options.difficulty = 0;
+    options.tolerance = 0;
+    options.attempts = 1;
+    Board board = LevelGenerator(options).generate(seed).board;
+    Solution solution = Solver(board).solve();
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            board.set_block(y, x, board.get_type(y, x), solution.orientations[y * size + x]);
+        }
+    }
+    return board;
+}
+
+// The water runs round a closed ring in the top-left corner
+static void addRing(Board &board) {
+    board.set_block(0, 0, BlockType::TJUNCTION, 1);
+    board.set_block(0, 1, BlockType::TURN, 2);
+    board.set_block(1, 0, BlockType::TURN, 0);
+    board.set_block(1, 1, BlockType::TURN, 3);
+}
+
+// Random, solved, slightly broken and ringed boards of the given size
+static vector<Board> mixedBoards(Random &random, int height, int width, int count) {
+    vector<Board> boards;
+    for (int i = 0; i < count; ++i) {
+        Board board = randomBoard(random, height, width, random.next_int(40));
+        switch (random.next_int(4)) {
+        case 0:
+            if (height == width && height >= 2) {
+                board = solvedBoard(height, random.next());
+                if (random.next_int(2)) board.rotate(random.next_int(height), random.next_int(width));
+            }
+            break;
+        case 1:
+            if (height >= 2 && width >= 2) addRing(board);
+            break;
+        case 2:
+            board.set_block(0, 0, BlockType::CROSS, 0);
+            break;
+        }
+        boards.push_back(board);
+    }
+    return boards;
+}
+
+TEST(evaluateMatchesQueueBfs) {
+    Random random{1};
+    // Every size evaluate() treats differently: 8x8 bit boards, the 16 and 32
+    // kernels and the general BFS
+    const int sizes[][2] = {{1, 1}, {1, 5}, {5, 1}, {3, 7}, {8, 8}, {8, 9}, {12, 12}, {16, 16}, {32, 32}};
+    for (size_t size = 0; size < sizeof(sizes) / sizeof(sizes[0]); ++size) {
+        vector<Board> boards = mixedBoards(random, sizes[size][0], sizes[size][1], 200);
+        for (size_t i = 0; i < boards.size(); ++i) {
+            vector<int> expectedLayers, layers;
+            BFSResult expected = referenceEvaluate(boards[i], expectedLayers);
+            BFSResult result = evaluate(boards[i], &layers);
+            if (!CHECK(result.status == expected.status && result.cycles == expected.cycles)) return;
+            if (!CHECK(layers == expectedLayers)) return;
+            if (!CHECK(evaluate(boards[i]).status == expected.status)) return;
+        }
+    }
+}
+
+TEST(evaluateParallelMatchesQueueBfs) {
+    Random random{2};
+    for (int round = 0; round < 300; ++round) {
+        int height = 1 + random.next_int(20);
+        int width = 1 + random.next_int(20);
+        vector<Board> boards = mixedBoards(random, height, width, 1);
+        vector<int> layers;
+        BFSStatus expected = referenceEvaluate(boards[0], layers).status;
+        for (int threads = 1; threads <= 4; ++threads) {
+            if (!CHECK(evaluateParallel(boards[0], threads).status == expected)) return;
+        }
+    }
+}
+
+TEST(boardBatchMatchesEvaluate) {
+    Random random{3};
+    for (int round = 0; round < 60; ++round) {
+        int height = 1 + random.next_int(16);
+        int width = round % 2 == 0 ? height : 1 + random.next_int(16);
+        // More than one batch, the last one partly filled
+        vector<Board> boards = mixedBoards(random, height, width, 1 + random.next_int(3 * BoardBatch::LANES));
+        vector<BFSStatus> statuses = evaluateBatch(boards);
+        if (!CHECK(statuses.size() == boards.size())) return;
+        for (size_t i = 0; i < boards.size(); ++i) {
+            if (!CHECK(statuses[i] == evaluate(boards[i]).status)) return;
+        }
+    }
+}
+
+TEST(boardBatchRejectsOtherSizes) {
+    BoardBatch batch{4, 4};
+    CHECK(batch.add(Board{4, 5}) == -1);
+    for (int lane = 0; lane < BoardBatch::LANES; ++lane) {
+        if (!CHECK(batch.add(Board{4, 4}) == lane)) return;
+    }
+    CHECK(batch.add(Board{4, 4}) == -1);
+    batch.clear();
+    CHECK(batch.get_count() == 0 && batch.add(Board{4, 4}) == 0);
+}
@@ -0,0 +1,163 @@
+#include <string>
+#include <vector>
+
+#include "history.h"
+#include "recording.h"
+#include "snapshot.h"
+#include "swipe.h"
+#include "test.h"
+
+using namespace std;
+
+// The same blocks set one at a time, so the hash is worked out afresh
+static uint64_t freshHash(const Board &board) {
+    Board fresh{board.get_height(), board.get_width()};
+    for (int y = 0; y < board.get_height(); ++y) {
+        for (int x = 0; x < board.get_width(); ++x) fresh.set_cell(y, x, board.get_cell(y, x));
+    }
+    return fresh.get_hash();
+}
+
+// Undo and redo as a list of every board the game went through, with the
+// block each move changed or History::ALL_BLOCKS
+struct StateStack {
+    vector<Board> states;
+    vector<int> blocks;
+    size_t position;
+
+    explicit StateStack(const Board &start): states(1, start), blocks(1, History::ALL_BLOCKS), position(0) {}
+
+    void add(const Board &board, int block) {
+        this->states.resize(this->position + 1);
+        this->blocks.resize(this->position + 1);
+        this->states.push_back(board);
+        this->blocks.push_back(block);
+        ++this->position;
+    }
+};
+
+TEST(historyMatchesStateStack) {
+    Random random{21};
+    for (int game = 0; game < 40; ++game) {
+        const int size = 2 + random.next_int(9);
+        Board board = randomBoard(random, size, size, 30);
+        History history;
+        StateStack expected{board};
+        for (int move = 0; move < 400; ++move) {
+            int action = random.next_int(10);
+            int block = -2;
+            if (action < 5) {
+                int y = random.next_int(size);
+                int x = random.next_int(size);
+                if (board.get_type(y, x) == BlockType::EMPTY) continue;
+                board.rotate(y, x);
+                history.add_rotation(y, x);
+                expected.add(board, y * size + x);
+            } else if (action < 7) {
+                history.add_snapshot(board);
+                swipe(board, static_cast<SwipeDirection>(random.next_int(4)));
+                addRandomPipe(board, random);
+                expected.add(board, History::ALL_BLOCKS);
+            } else if (action < 9) {
+                bool undone = history.undo(board, &block);
+                if (!CHECK(undone == (expected.position > 0))) return;
+                if (undone && !CHECK(block == expected.blocks[expected.position--])) return;
+            } else {
+                bool redone = history.redo(board, &block);
+                if (!CHECK(redone == (expected.position + 1 < expected.states.size()))) return;
+                if (redone && !CHECK(block == expected.blocks[++expected.position])) return;
+            }
+            if (!CHECK(board == expected.states[expected.position])) return;
+            if (!CHECK(board.get_hash() == freshHash(board))) return;
+            if (!CHECK(history.can_undo() == (expected.position > 0))) return;
+            if (!CHECK(history.can_redo() == (expected.position + 1 < expected.states.size()))) return;
+        }
+    }
+}
+
+TEST(packedBoardsRoundTrip) {
+    Random random{22};
+    for (int round = 0; round < 500; ++round) {
+        Board board = randomBoard(random, 1 + random.next_int(20), 1 + random.next_int(20), random.next_int(50));
+        vector<uint64_t> words(packedWords(board.get_height(), board.get_width()));
+        packBoard(board, words.data());
+        Board unpacked{board.get_height(), board.get_width()};
+        unpackBoard(words.data(), unpacked);
+        if (!CHECK(unpacked == board && unpacked.get_hash() == board.get_hash())) return;
+    }
+}
+
+TEST(recordingsReplayTheGame) {
+    Random random{23};
+    for (int game = 0; game < 30; ++game) {
+        const int size = 2 + random.next_int(9);
+        const uint64_t seed = random.next();
+        const int flags = game % 2 == 0 ? Recording::SPAWNS : 0;
+        Board board = randomBoard(random, size, size, 30);
+        Recording recording{board, seed, 1 + game, flags};
+
+        // Played by hand with the same spawns the replay draws
+        Random spawns{seed};
+        StateStack states{board};
+        vector<Board> boards;
+        vector<RecordedEvent> events;
+        for (int move = 0; move < 200; ++move) {
+            RecordedEvent event = {static_cast<RecordedEvent::Kind>(random.next_int(4)), 0,
+                                   static_cast<uint32_t>(random.next_int(random.next_int(2) ? 100 : 100000))};
+            switch (event.kind) {
+            case RecordedEvent::ROTATE: {
+                int y = random.next_int(size);
+                int x = random.next_int(size);
+                event.value = y * size + x;
+                recording.add_rotation(y, x, event.delay);
+                // Clicks on empty blocks are recorded but change nothing
+                if (board.get_type(y, x) != BlockType::EMPTY) {
+                    board.rotate(y, x);
+                    states.add(board, event.value);
+                }
+                break;
+            }
+            case RecordedEvent::SWIPE:
+                event.value = random.next_int(4);
+                recording.add_swipe(static_cast<SwipeDirection>(event.value), event.delay);
+                swipe(board, static_cast<SwipeDirection>(event.value));
+                if (flags & Recording::SPAWNS) addRandomPipe(board, spawns);
+                states.add(board, History::ALL_BLOCKS);
+                break;
+            case RecordedEvent::UNDO:
+                recording.add_undo(event.delay);
+                if (states.position > 0) board = states.states[--states.position];
+                break;
+            case RecordedEvent::REDO:
+                recording.add_redo(event.delay);
+                if (states.position + 1 < states.states.size()) board = states.states[++states.position];
+                break;
+            }
+            boards.push_back(board);
+            events.push_back(event);
+        }
+
+        const string data = recording.serialize();
+        Recording parsed;
+        if (!CHECK(parsed.parse(data.data(), data.size()))) return;
+        if (!CHECK(parsed.get_start() == recording.get_start() && parsed.get_seed() == seed
+                   && parsed.get_level() == 1 + game && parsed.get_flags() == flags
+                   && parsed.get_event_count() == static_cast<int>(events.size()))) return;
+
+        Replayer replayer{parsed};
+        uint64_t time = 0;
+        for (size_t i = 0; i < events.size(); ++i) {
+            RecordedEvent event;
+            if (!CHECK(replayer.step(&event))) return;
+            time += events[i].delay;
+            if (!CHECK(event.kind == events[i].kind && event.value == events[i].value
+                       && event.delay == events[i].delay && replayer.get_time() == time)) return;
+            if (!CHECK(replayer.get_board() == boards[i])) return;
+        }
+        CHECK(!replayer.step());
+        replayer.reset();
+        CHECK(replayer.run() == static_cast<int>(events.size()) && replayer.get_board() == board);
+        // Cut short, the data no longer parses
+        CHECK(!parsed.parse(data.data(), data.size() - 1));
+    }
+}
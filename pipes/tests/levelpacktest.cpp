@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "levelpack.h"
+#include "test.h"
+
+using namespace std;
+
+// Levels held in memory
+class BoardList : public LevelSource
+{
+ public:
+    vector<Board> boards;
+
+    int get_count() const {
+        return static_cast<int>(this->boards.size());
+    }
+
+    bool load_level(int level, Board &board) const {
+        if (level < 1 || level > this->get_count()) return false;
+        board = this->boards[level - 1];
+        return true;
+    }
+};
+
+static void put32(unsigned char *data, uint32_t value) {
+    for (int i = 0; i < 4; ++i) data[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+TEST(levelPacksRoundTrip) {
+    Random random{31};
+    BoardList levels;
+    for (int i = 0; i < 50; ++i) levels.boards.push_back(randomBoard(random, 7, 9, 10 * (i % 10)));
+    const char *path = "pipestests.pack";
+    if (!CHECK(LevelPack::write(path, levels))) return;
+    LevelPack pack;
+    bool opened = pack.open(path);
+    remove(path);
+    if (!CHECK(opened && pack.get_count() == 50 && pack.get_height() == 7 && pack.get_width() == 9)) return;
+    for (int level = 1; level <= 50; ++level) {
+        Board board;
+        if (!CHECK(pack.load_level(level, board) && board == levels.boards[level - 1])) return;
+    }
+    Board board;
+    CHECK(!pack.load_level(0, board) && !pack.load_level(51, board));
+}
+
+TEST(levelPacksRejectBadHeaders) {
+    // One 1x1 level: header, two offsets, one block
+    unsigned char data[LevelPack::HEADER_SIZE + 9] = {'P', 'I', 'P', 'E', 'P', 'A', 'C', 'K', 1, 0, 1, 0, 1, 0};
+    put32(data + 16, 1);
+    put32(data + LevelPack::HEADER_SIZE, LevelPack::HEADER_SIZE + 8);
+    put32(data + LevelPack::HEADER_SIZE + 4, LevelPack::HEADER_SIZE + 9);
+    data[LevelPack::HEADER_SIZE + 8] = BlockType::CROSS;
+    LevelPack pack;
+    Board board;
+    if (!CHECK(pack.open(data, sizeof(data)) && pack.load_level(1, board))) return;
+    CHECK(board.get_height() == 1 && board.get_type(0, 0) == BlockType::CROSS);
+
+    unsigned char bad[sizeof(data)];
+    // A count that reads as negative
+    memcpy(bad, data, sizeof(data));
+    put32(bad + 16, 0xFFFFFFFFu);
+    CHECK(!pack.open(bad, sizeof(bad)));
+    // Boards too large to allocate
+    memcpy(bad, data, sizeof(data));
+    bad[10] = bad[11] = bad[12] = bad[13] = 0xFF;
+    CHECK(!pack.open(bad, sizeof(bad)));
+    // No blocks at all
+    memcpy(bad, data, sizeof(data));
+    bad[10] = 0;
+    CHECK(!pack.open(bad, sizeof(bad)));
+    // A level starting inside the index
+    memcpy(bad, data, sizeof(data));
+    put32(bad + LevelPack::HEADER_SIZE, LevelPack::HEADER_SIZE + 4);
+    CHECK(pack.open(bad, sizeof(bad)) && !pack.load_level(1, board));
+}
@@ -0,0 +1,66 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+using namespace std;
+
+struct Test {
+    const char *name;
+    TestFunction function;
+};
+
+// Filled during static initialization, so it can not be a plain global
+static vector<Test> &registeredTests() {
+    static vector<Test> tests;
+    return tests;
+}
+
+// Failed checks of the running test
+static int failures = 0;
+
+TestRegistration::TestRegistration(const char *name, TestFunction function) {
+    registeredTests().push_back({name, function});
+}
+
+bool checkCondition(bool condition, const char *expression, const char *file, int line) {
+    if (condition) return true;
+    // A test looping over many boards would repeat the same failure
+    if (failures < 10) fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    ++failures;
+    return false;
+}
+
+Board randomBoard(Random &random, int height, int width, int emptyPercent) {
+    Board board{height, width};
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (random.next_int(100) >= emptyPercent) {
+                board.set_block(y, x, static_cast<BlockType>(random.next_int(4)), random.next_int(4));
+            } else {
+                board.set_block(y, x, BlockType::EMPTY, random.next_int(4));
+            }
+        }
+    }
+    return board;
+}
+
+// pipestests [filter]: runs the tests whose name contains `filter`
+int main(int argc, char *argv[])
+{
+    const char *filter = argc > 1 ? argv[1] : "";
+    int run = 0;
+    int failed = 0;
+    const vector<Test> &tests = registeredTests();
+    for (size_t i = 0; i < tests.size(); ++i) {
+        if (strstr(tests[i].name, filter) == nullptr) continue;
+        failures = 0;
+        tests[i].function();
+        ++run;
+        if (failures > 0) ++failed;
+        printf("%-40s %s\n", tests[i].name, failures == 0 ? "ok" : "FAILED");
+    }
+    printf("%d of %d tests failed\n", failed, run);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "recordstore.h"
+#include "test.h"
+
+using namespace std;
+
+static const char *RECORDS = "pipestests.records";
+
+static bool matches(RecordStore &store, const map<int, int> &expected) {
+    for (map<int, int>::const_iterator record = expected.begin(); record != expected.end(); ++record) {
+        if (store.get_record(record->first) != record->second) return false;
+    }
+    return true;
+}
+
+TEST(recordStoresRoundTrip) {
+    remove(RECORDS);
+    Random random{41};
+    map<int, int> expected;
+    {
+        RecordStore store{RECORDS};
+        // Levels spread over many pages, some of them set more than once
+        for (int i = 0; i < 3000; ++i) {
+            int level = random.next_int(2) ? random.next_int(5000) : random.next_int(400000);
+            int value = random.next_int(1000);
+            store.update_record(level, value);
+            expected[level] = value;
+        }
+        if (!CHECK(store.is_valid() && matches(store, expected))) return;
+    }
+
+    RecordStore reopened{RECORDS};
+    if (!CHECK(reopened.is_valid() && matches(reopened, expected))) return;
+    CHECK(reopened.get_record(400001) == -1 && reopened.get_record(-1) == -1);
+
+    // A flushed update is on disk while the store is still open
+    for (int i = 0; i < 200; ++i) {
+        int level = random.next_int(400000);
+        int value = random.next_int(1000);
+        reopened.update_record(level, value);
+        expected[level] = value;
+    }
+    if (!CHECK(reopened.flush())) return;
+    RecordStore reader{RECORDS};
+    CHECK(reader.is_valid() && matches(reader, expected));
+    remove(RECORDS);
+}
+
+TEST(recordStoresIgnoreLeftoverTemporaries) {
+    remove(RECORDS);
+    map<int, int> expected;
+    {
+        RecordStore store{RECORDS};
+        for (int level = 1; level <= 2000; level += 7) {
+            store.update_record(level, level % 97);
+            expected[level] = level % 97;
+        }
+    }
+
+    // What a crash in the middle of a write leaves behind
+    string temporary = string(RECORDS) + ".tmp";
+    FILE *leftover = fopen(temporary.c_str(), "wb");
+    if (!CHECK(leftover != nullptr)) return;
+    fputs("PIPESCOR half written", leftover);
+    fclose(leftover);
+
+    {
+        RecordStore store{RECORDS};
+        if (!CHECK(store.is_valid() && matches(store, expected))) return;
+        store.update_record(3, 1);
+        expected[3] = 1;
+        if (!CHECK(store.flush())) return;
+    }
+    RecordStore reopened{RECORDS};
+    CHECK(reopened.is_valid() && matches(reopened, expected));
+    remove(temporary.c_str());
+    remove(RECORDS);
+}
@@ -0,0 +1,148 @@
+#include <set>
+#include <vector>
+
+#include "counter.h"
+#include "evaluator.h"
+#include "hint.h"
+#include "solver.h"
+#include "test.h"
+
+using namespace std;
+
+struct BruteForce {
+    // Fewest clockwise rotations to CONNECTED, -1 if none
+    int steps;
+    uint64_t assignments;
+    uint64_t networks;
+};
+
+// Tries every orientation of every pipe
+static BruteForce bruteForce(const Board &board) {
+    const int width = board.get_width();
+    vector<int> pipes;
+    for (int index = 0; index < board.get_height() * width; ++index) {
+        if (board.get_type(index / width, index % width) != BlockType::EMPTY) pipes.push_back(index);
+    }
+    BruteForce result = {-1, 0, 0};
+    set<vector<int> > networks;
+    Board trial = board;
+    for (uint64_t code = 0; code < 1ULL << (2 * pipes.size()); ++code) {
+        int steps = 0;
+        for (size_t i = 0; i < pipes.size(); ++i) {
+            int y = pipes[i] / width;
+            int x = pipes[i] % width;
+            int orientation = static_cast<int>(code >> (2 * i) & 3);
+            trial.set_block(y, x, board.get_type(y, x), orientation);
+            steps += (orientation - board.get_orientation(y, x) + 4) % 4;
+        }
+        vector<int> layers;
+        if (evaluate(trial, &layers).status != BFSStatus::CONNECTED) continue;
+        ++result.assignments;
+        if (result.steps < 0 || steps < result.steps) result.steps = steps;
+        // A network is the wet blocks and the way they point
+        vector<int> network(layers.size(), -1);
+        for (size_t index = 0; index < layers.size(); ++index) {
+            if (layers[index] >= 0) network[index] = Board::cell_direction(trial.get_cells()[index]);
+        }
+        networks.insert(network);
+    }
+    result.networks = networks.size();
+    return result;
+}
+
+// Small boards with few enough pipes to try them all, leaning towards
+// turns and T-junctions so that some of them connect
+static vector<Board> smallBoards(Random &random, int count, int maxPipes) {
+    vector<Board> boards;
+    while (static_cast<int>(boards.size()) < count) {
+        int height = 1 + random.next_int(4);
+        int width = 1 + random.next_int(4);
+        Board board{height, width};
+        int pipes = 0;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int roll = random.next_int(12);
+                BlockType type = roll == 0 ? BlockType::EMPTY : roll == 1 ? BlockType::CROSS
+                               : roll < 5 ? BlockType::STRAIGHT : roll < 9 ? BlockType::TURN : BlockType::TJUNCTION;
+                board.set_block(y, x, type, random.next_int(4));
+                if (type != BlockType::EMPTY) ++pipes;
+            }
+        }
+        if (pipes <= maxPipes) boards.push_back(board);
+    }
+    return boards;
+}
+
+static int clicksTo(const Board &board, const vector<int> &orientations) {
+    int clicks = 0;
+    for (int y = 0; y < board.get_height(); ++y) {
+        for (int x = 0; x < board.get_width(); ++x) {
+            clicks += (orientations[y * board.get_width() + x] - board.get_orientation(y, x) + 4) % 4;
+        }
+    }
+    return clicks;
+}
+
+TEST(solverFindsTheOptimum) {
+    Random random{11};
+    vector<Board> boards = smallBoards(random, 400, 7);
+    int solvable = 0;
+    for (size_t i = 0; i < boards.size(); ++i) {
+        const Board &board = boards[i];
+        BruteForce expected = bruteForce(board);
+        Solution solution = Solver(board).solve();
+        if (!CHECK(solution.solvable == (expected.steps >= 0))) return;
+        if (!solution.solvable) continue;
+        ++solvable;
+        if (!CHECK(solution.steps == expected.steps)) return;
+        // The orientations reach CONNECTED in exactly that many clicks
+        Board solved = board;
+        for (int y = 0; y < board.get_height(); ++y) {
+            for (int x = 0; x < board.get_width(); ++x) {
+                solved.set_block(y, x, board.get_type(y, x), solution.orientations[y * board.get_width() + x]);
+            }
+        }
+        if (!CHECK(evaluate(solved).status == BFSStatus::CONNECTED)) return;
+        if (!CHECK(clicksTo(board, solution.orientations) == expected.steps)) return;
+        // Nothing strictly cheaper than a bound is found when the bound is the optimum
+        if (!CHECK(!Solver(board).solve(expected.steps).solvable)) return;
+        if (!CHECK(Solver(board).solve(expected.steps + 1).steps == expected.steps)) return;
+    }
+    // The boards must exercise both outcomes
+    CHECK(solvable > 20 && solvable < static_cast<int>(boards.size()));
+}
+
+TEST(solutionCounterMatchesBruteForce) {
+    Random random{12};
+    vector<Board> boards = smallBoards(random, 400, 7);
+    for (size_t i = 0; i < boards.size(); ++i) {
+        BruteForce expected = bruteForce(boards[i]);
+        SolutionCount count = SolutionCounter(boards[i]).count();
+        if (!CHECK(count.assignments == BigCount(expected.assignments))) return;
+        if (!CHECK(count.networks == BigCount(expected.networks))) return;
+    }
+}
+
+TEST(hintsLeadToTheOptimum) {
+    Random random{13};
+    vector<Board> boards = smallBoards(random, 300, 7);
+    // One engine for all boards, so a changed board has to drop the old target
+    HintEngine engine;
+    for (size_t i = 0; i < boards.size(); ++i) {
+        Board board = boards[i];
+        BruteForce expected = bruteForce(board);
+        Hint hint = engine.hint(board);
+        if (!CHECK(hint.solvable == (expected.steps >= 0))) return;
+        if (!hint.solvable) continue;
+        if (!CHECK(hint.remaining == expected.steps)) return;
+        // Following the hints spends exactly the optimum
+        while (hint.remaining > 0) {
+            if (!CHECK(hint.clicks >= 1 && hint.clicks <= 3 && board.contains(hint.y, hint.x))) return;
+            int remaining = hint.remaining - hint.clicks;
+            for (int click = 0; click < hint.clicks; ++click) board.rotate(hint.y, hint.x);
+            hint = engine.hint(board);
+            if (!CHECK(hint.solvable && hint.remaining == remaining)) return;
+        }
+        if (!CHECK(hint.y == -1 && evaluate(board).status == BFSStatus::CONNECTED)) return;
+    }
+}
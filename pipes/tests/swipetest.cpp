@@ -0,0 +1,74 @@
+#include <vector>
+
+#include "swipe.h"
+#include "test.h"
+
+using namespace std;
+
+// The swipe as the game first had it: each line read out block by block,
+// equal neighbours merged with combine() and the survivors pushed together
+static Board referenceSwipe(const Board &board, SwipeDirection direction) {
+    const int height = board.get_height();
+    const int width = board.get_width();
+    const bool rows = direction == SWIPE_LEFT || direction == SWIPE_RIGHT;
+    const bool reversed = direction == SWIPE_RIGHT || direction == SWIPE_DOWN;
+    const int lines = rows ? height : width;
+    const int size = rows ? width : height;
+    Board result{height, width};
+    for (int line = 0; line < lines; ++line) {
+        vector<BlockData> blocks;
+        for (int i = 0; i < size; ++i) {
+            int along = reversed ? size - 1 - i : i;
+            BlockData block = rows ? board.get_block(line, along) : board.get_block(along, line);
+            if (block.type != BlockType::EMPTY) blocks.push_back(block);
+        }
+        int left = -1;
+        for (int i = 0; i < static_cast<int>(blocks.size()); ++i) {
+            if (left < 0 || blocks[i].type != blocks[left].type) {
+                left = i;
+            } else {
+                combine(blocks[left], blocks[i]);
+                left = -1;
+            }
+        }
+        int position = 0;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (blocks[i].type == BlockType::EMPTY) continue;
+            int along = reversed ? size - 1 - position : position;
+            if (rows) {
+                result.set_block(line, along, blocks[i]);
+            } else {
+                result.set_block(along, line, blocks[i]);
+            }
+            ++position;
+        }
+    }
+    return result;
+}
+
+TEST(swipeMatchesCombine) {
+    Random random{51};
+    // Lines through the table, the long-line kernel, and the 16 and 32 kernels
+    const int sizes[][2] = {{1, 1}, {1, 8}, {3, 5}, {7, 2}, {8, 8}, {8, 9}, {9, 8}, {12, 12},
+                            {16, 16}, {16, 8}, {32, 32}};
+    for (size_t size = 0; size < sizeof(sizes) / sizeof(sizes[0]); ++size) {
+        for (int round = 0; round < 200; ++round) {
+            Board board = randomBoard(random, sizes[size][0], sizes[size][1], random.next_int(80));
+            // Long runs of one type merge over and over
+            if (round % 4 == 0) {
+                BlockType type = static_cast<BlockType>(random.next_int(BlockType::EMPTY));
+                for (int y = 0; y < board.get_height(); ++y) {
+                    for (int x = 0; x < board.get_width(); ++x) {
+                        if (random.next_int(4) != 0) board.set_block(y, x, type, random.next_int(4));
+                    }
+                }
+            }
+            for (int direction = SWIPE_LEFT; direction <= SWIPE_DOWN; ++direction) {
+                Board expected = referenceSwipe(board, static_cast<SwipeDirection>(direction));
+                Board swiped = board;
+                swipe(swiped, static_cast<SwipeDirection>(direction));
+                if (!CHECK(swiped == expected && swiped.get_hash() == expected.get_hash())) return;
+            }
+        }
+    }
+}
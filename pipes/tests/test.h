@@ -0,0 +1,27 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include "board.h"
+#include "random.h"
+
+// Tests register themselves by name. CHECK reports a failed condition and
+// returns whether it held, so a loop over many boards can stop at the first.
+typedef void (*TestFunction)();
+
+struct TestRegistration {
+    TestRegistration(const char *name, TestFunction function);
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistration name##Registration(#name, name); \
+    static void name()
+
+bool checkCondition(bool condition, const char *expression, const char *file, int line);
+
+#define CHECK(condition) checkCondition((condition), #condition, __FILE__, __LINE__)
+
+// Blocks of random types and orientations, about `emptyPercent` of them empty
+Board randomBoard(Random &random, int height, int width, int emptyPercent);
+
+#endif // TEST_H
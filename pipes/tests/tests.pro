@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Checks of the board kernels against plain references
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+# testcase adds `make check`, which runs the tests
+CONFIG += console c++11 thread testcase
+CONFIG -= qt app_bundle
+
+TARGET = pipestests
+
+include(../core/core.pri)
+
+HEADERS += test.h
+
+SOURCES += main.cpp \
+    evaluatortest.cpp \
+    historytest.cpp \
+    levelpacktest.cpp \
+    recordstoretest.cpp \
+    solvertest.cpp \
+    swipetest.cpp
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Counts the solutions of every level
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = levelcount
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
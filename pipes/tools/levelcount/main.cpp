@@ -0,0 +1,45 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "counter.h"
+#include "levelparser.h"
+#include "levelsource.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <levels>\n"
+                        "Reads maps.txt syntax or a level pack and prints for every level whether it has\n"
+                        "no solution, a unique one or several, the number of distinct water networks\n"
+                        "reaching the outlet and the number of orientation assignments that do.\n", argv[0]);
+        return 2;
+    }
+
+    ParseError error;
+    unique_ptr<LevelSource> levels = openLevels(argv[1], &error);
+    if (!levels) {
+        fprintf(stderr, "%s:%d:%d: %s\n", argv[1], error.line, error.column, error.message.c_str());
+        return 1;
+    }
+
+    int totals[3] = {0, 0, 0};
+    static const char *names[3] = {"none", "unique", "multiple"};
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Board board;
+    for (int level = 1; level <= levels->get_count(); ++level) {
+        levels->load_level(level, board);
+        SolutionCount count = SolutionCounter(board).count();
+        int kind = count.networks.is_zero() ? 0 : count.networks == BigCount(1) ? 1 : 2;
+        ++totals[kind];
+        printf("level %d: %-8s networks %s assignments %s\n", level, names[kind],
+               count.networks.to_string().c_str(), count.assignments.to_string().c_str());
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    printf("%d none, %d unique, %d multiple in %.3f s\n", totals[0], totals[1], totals[2], seconds);
+    return 0;
+}
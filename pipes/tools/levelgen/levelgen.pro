@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Generates solvable levels
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = levelgen
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "generator.h"
+#include "levelpack.h"
+#include "levelparser.h"
+
+using namespace std;
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [options] <output>\n"
+                    "  --count N       levels to generate (100)\n"
+                    "  --seed N        seed, the same seed gives the same levels (1)\n"
+                    "  --threads N     worker threads, 0 for all cores (0)\n"
+                    "  --size N        board size (8)\n"
+                    "  --difficulty N  target minimum number of rotations (30)\n"
+                    "  --tolerance N   accepted distance from the target (8)\n"
+                    "  --detours N     T-junction loops per level (2)\n"
+                    "  --empty N       percent of decoy blocks left empty (40)\n"
+                    "Writes a level pack if the output ends in .pack, maps.txt syntax otherwise.\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    GeneratorOptions options;
+    int count = 100;
+    unsigned long long seed = 1;
+    int threads = 0;
+    string output;
+
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option.compare(0, 2, "--") != 0) {
+            output = option;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *value = argv[++i];
+        if (option == "--count") count = atoi(value);
+        else if (option == "--seed") seed = strtoull(value, nullptr, 10);
+        else if (option == "--threads") threads = atoi(value);
+        else if (option == "--size") options.height = options.width = atoi(value);
+        else if (option == "--difficulty") options.difficulty = atoi(value);
+        else if (option == "--tolerance") options.tolerance = atoi(value);
+        else if (option == "--detours") options.detours = atoi(value);
+        else if (option == "--empty") options.emptyPercent = atoi(value);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (output.empty() || count < 0 || options.height < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<GeneratedLevel> levels = LevelGenerator(options).generate(seed, count, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    LevelTable table;
+    int missed = 0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        table.add_level(levels[i].board);
+        if (abs(levels[i].steps - options.difficulty) > options.tolerance) ++missed;
+    }
+
+    bool written;
+    if (output.size() >= 5 && output.compare(output.size() - 5, 5, ".pack") == 0) {
+        written = LevelPack::write(output, table);
+    } else {
+        ofstream file(output.c_str(), ios::binary);
+        for (int level = 1; level <= table.get_count(); ++level) {
+            file << formatLevel(table.get_level(level));
+        }
+        written = static_cast<bool>(file);
+    }
+    if (!written) {
+        fprintf(stderr, "%s: can not write the levels\n", output.c_str());
+        return 1;
+    }
+
+    printf("%d levels in %.3f s (%.0f levels/s), %d outside the target difficulty\n",
+           count, seconds, seconds > 0 ? count / seconds : 0.0, missed);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "levelpack.h"
+#include "levelparser.h"
+#include "levelsource.h"
+
+using namespace std;
+
+static bool endsWith(const string &text, const string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <input> <output>\n"
+                        "Reads maps.txt syntax or a level pack; writes a pack if the output ends in .pack,\n"
+                        "maps.txt syntax otherwise.\n", argv[0]);
+        return 2;
+    }
+
+    ParseError error;
+    unique_ptr<LevelSource> levels = openLevels(argv[1], &error);
+    if (!levels) {
+        fprintf(stderr, "%s:%d:%d: %s\n", argv[1], error.line, error.column, error.message.c_str());
+        return 1;
+    }
+
+    string output = argv[2];
+    if (endsWith(output, ".pack")) {
+        if (!LevelPack::write(output, *levels)) {
+            fprintf(stderr, "%s: can not write the pack, are all levels the same size?\n", argv[2]);
+            return 1;
+        }
+    } else {
+        ofstream file(output.c_str(), ios::binary);
+        Board board;
+        for (int level = 1; level <= levels->get_count() && file; ++level) {
+            levels->load_level(level, board);
+            file << formatLevel(board);
+        }
+        if (!file) {
+            fprintf(stderr, "%s: can not write the levels\n", argv[2]);
+            return 1;
+        }
+    }
+
+    printf("%d levels written to %s\n", levels->get_count(), argv[2]);
+    return 0;
+}
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Converts levels between maps.txt and level packs
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = mapconvert
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bot.h"
+
+using namespace std;
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [options]\n"
+                    "  --games N       games to play (1000)\n"
+                    "  --seed N        seed, the same seed plays the same games (1)\n"
+                    "  --threads N     worker threads, 0 for all cores (0)\n"
+                    "  --size N        board size (8)\n"
+                    "  --depth N       swipes looked ahead (2)\n"
+                    "  --samples N     spawns averaged per chance node, 0 for all (8)\n"
+                    "  --spawn TYPES   comma separated spawn types (straight,cross)\n"
+                    "  --max-moves N   swipes before a game is lost (200)\n", name);
+}
+
+static bool parseTypes(const string &value, int &types) {
+    static const char *names[] = {"tjunction", "turn", "straight", "cross"};
+    types = 0;
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == string::npos) end = value.size();
+        string name = value.substr(start, end - start);
+        int type = 0;
+        while (type < 4 && name != names[type]) ++type;
+        if (type == 4) return false;
+        types |= 1 << type;
+        start = end + 1;
+    }
+    return types != 0;
+}
+
+static int percentile(const vector<int> &sorted, int percent) {
+    if (sorted.empty()) return 0;
+    return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+int main(int argc, char *argv[])
+{
+    BotOptions options;
+    int games = 1000;
+    unsigned long long seed = 1;
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *value = argv[++i];
+        if (option == "--games") games = atoi(value);
+        else if (option == "--seed") seed = strtoull(value, nullptr, 10);
+        else if (option == "--threads") threads = atoi(value);
+        else if (option == "--size") options.size = atoi(value);
+        else if (option == "--depth") options.depth = atoi(value);
+        else if (option == "--samples") options.samples = atoi(value);
+        else if (option == "--max-moves") options.maxMoves = atoi(value);
+        else if (option == "--spawn") {
+            if (!parseTypes(value, options.spawnTypes)) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (games < 1 || options.size < 2 || options.depth < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<BotGame> results = playGames(options, seed, games, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long swipes = 0;
+    long long nodes = 0;
+    vector<int> wonMoves;
+    for (size_t i = 0; i < results.size(); ++i) {
+        swipes += results[i].swipes;
+        nodes += results[i].nodes;
+        if (results[i].won) wonMoves.push_back(results[i].swipes + results[i].rotations);
+    }
+    sort(wonMoves.begin(), wonMoves.end());
+
+    printf("%d games, %d won (%.1f%%)\n", games, static_cast<int>(wonMoves.size()),
+           100.0 * wonMoves.size() / games);
+    if (!wonMoves.empty()) {
+        printf("moves to win, swipes and rotations: min %d  p25 %d  median %d  p75 %d  p95 %d  max %d\n",
+               wonMoves.front(), percentile(wonMoves, 25), percentile(wonMoves, 50),
+               percentile(wonMoves, 75), percentile(wonMoves, 95), wonMoves.back());
+
+        // Histogram in ten buckets
+        int low = wonMoves.front();
+        int bucket = max(1, (wonMoves.back() - low) / 10 + 1);
+        vector<int> counts(10, 0);
+        for (size_t i = 0; i < wonMoves.size(); ++i) {
+            ++counts[min(9, (wonMoves[i] - low) / bucket)];
+        }
+        for (int i = 0; i < 10; ++i) {
+            if (counts[i] == 0) continue;
+            int width = static_cast<int>(50.0 * counts[i] / wonMoves.size() + 0.5);
+            printf("  %4d-%-4d %6d %s\n", low + i * bucket, low + (i + 1) * bucket - 1, counts[i],
+                   string(static_cast<size_t>(width), '#').c_str());
+        }
+    }
+    printf("%lld swipes in %.3f s: %.0f swipes/s, %.0f chance nodes/s\n", swipes, seconds,
+           seconds > 0 ? swipes / seconds : 0.0, seconds > 0 ? nodes / seconds : 0.0);
+    return 0;
+}
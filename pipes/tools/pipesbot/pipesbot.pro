@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Plays the feature mode headless
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = pipesbot
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
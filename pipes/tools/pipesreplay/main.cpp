@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "evaluator.h"
+#include "recording.h"
+
+using namespace std;
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [options] <recording>...\n"
+                    "  --repeat N   replay every recording N times to measure the speed (1)\n"
+                    "  --events     print every event\n", name);
+}
+
+static const char *statusName(BFSStatus status) {
+    switch (status) {
+    case BFSStatus::CONNECTED:
+        return "connected";
+    case BFSStatus::LEAKAGE:
+        return "leakage";
+    default:
+        return "stuck";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int repeat = 1;
+    bool printEvents = false;
+    vector<string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--events") {
+            printEvents = true;
+        } else if (option == "--repeat" && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (option.compare(0, 2, "--") == 0) {
+            usage(argv[0]);
+            return 2;
+        } else {
+            paths.push_back(option);
+        }
+    }
+    if (paths.empty() || repeat < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    static const char *directions[] = {"left", "up", "right", "down"};
+    long long events = 0;
+    double seconds = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        Recording recording;
+        if (!recording.load(paths[i])) {
+            fprintf(stderr, "%s: not a recording or damaged\n", paths[i].c_str());
+            return 1;
+        }
+
+        Replayer replayer{recording};
+        if (printEvents) {
+            RecordedEvent event;
+            while (replayer.step(&event)) {
+                if (event.kind == RecordedEvent::ROTATE) {
+                    printf("%8llu ms  rotate %d,%d\n", static_cast<unsigned long long>(replayer.get_time()),
+                           event.value / recording.get_start().get_width(), event.value % recording.get_start().get_width());
+                } else if (event.kind == RecordedEvent::SWIPE) {
+                    printf("%8llu ms  swipe %s\n", static_cast<unsigned long long>(replayer.get_time()),
+                           directions[event.value]);
+                } else {
+                    printf("%8llu ms  %s\n", static_cast<unsigned long long>(replayer.get_time()),
+                           event.kind == RecordedEvent::UNDO ? "undo" : "redo");
+                }
+            }
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int round = 0; round < repeat; ++round) {
+            replayer.reset();
+            events += replayer.run();
+        }
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        BFSResult result = evaluate(replayer.get_board());
+        printf("%s: level %d, seed %llu, %d events over %.1f s, ends %s\n", paths[i].c_str(),
+               recording.get_level(), static_cast<unsigned long long>(recording.get_seed()),
+               recording.get_event_count(), replayer.get_time() / 1000.0, statusName(result.status));
+    }
+
+    printf("%lld events replayed in %.3f s (%.0f events/s)\n", events, seconds,
+           seconds > 0 ? events / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Replays recorded games headless
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = pipesreplay
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,596 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "levelparser.h"
+#include "levelsource.h"
+#include "session.h"
+#include "threadpool.h"
+
+using namespace std;
+
+// Replies queued before a client stops being served until it reads them
+static const size_t OUTPUT_LIMIT = 1 << 20;
+static const size_t READ_CHUNK = 64 * 1024;
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [options] [levels]\n"
+                    "Serves headless games, one command per line, on stdin or a Unix socket.\n"
+                    "  --socket PATH   listen on PATH instead of stdin\n"
+                    "  --threads N     worker threads, 0 for all cores (0)\n"
+                    "commands, every line gets one reply line, \"ok ...\" or \"err <reason>\":\n"
+                    "  new <level>                  -> ok <id>\n"
+                    "  new feature [seed]           -> ok <id>, the 2048 mode\n"
+                    "  rotate <id> <y> <x>...       -> ok <steps>\n"
+                    "  swipe <id> left|up|right|down...  -> ok <last new pipe y * width + x or -1>\n"
+                    "  evaluate <id>                -> ok connected|leakage|stuck <cycles>\n"
+                    "  snapshot <id>                -> ok <steps> <height> <width> <one base-32 cell each>\n"
+                    "  close <id>                   -> ok\n", name);
+}
+
+// A client: its own sessions, the bytes read but not run yet and the replies
+// not written yet. At most one batch of its commands runs at a time, so the
+// sessions need no lock and replies keep the order of the commands.
+struct Connection {
+    int in;
+    int out;
+    // Regular files can not be watched and are read whenever the client is idle
+    bool pollable;
+    bool ended;
+    bool busy;
+    string input;
+    string output;
+    unordered_map<uint32_t, GameSession> sessions;
+    uint32_t nextId;
+};
+
+// Shared by every connection, read only once the server runs
+struct Server {
+    unique_ptr<LevelSource> levels;
+};
+
+namespace {
+
+struct Tokens {
+    static const int CAPACITY = 256;
+    const char *words[CAPACITY];
+    int lengths[CAPACITY];
+    int count;
+};
+
+// False when the line has more words than fit
+bool split(const char *line, size_t length, Tokens &tokens) {
+    tokens.count = 0;
+    size_t i = 0;
+    while (i < length) {
+        while (i < length && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+        if (i == length) break;
+        if (tokens.count == Tokens::CAPACITY) return false;
+        size_t start = i;
+        while (i < length && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+        tokens.words[tokens.count] = line + start;
+        tokens.lengths[tokens.count] = static_cast<int>(i - start);
+        ++tokens.count;
+    }
+    return true;
+}
+
+bool is(const Tokens &tokens, int index, const char *word) {
+    return tokens.lengths[index] == static_cast<int>(strlen(word))
+        && memcmp(tokens.words[index], word, tokens.lengths[index]) == 0;
+}
+
+bool number(const Tokens &tokens, int index, unsigned long long &value) {
+    if (tokens.lengths[index] == 0 || tokens.lengths[index] > 19) return false;
+    value = 0;
+    for (int i = 0; i < tokens.lengths[index]; ++i) {
+        char digit = tokens.words[index][i];
+        if (digit < '0' || digit > '9') return false;
+        value = value * 10 + static_cast<unsigned long long>(digit - '0');
+    }
+    return true;
+}
+
+bool direction(const Tokens &tokens, int index, SwipeDirection &value) {
+    static const char *names[] = {"left", "up", "right", "down"};
+    for (int i = 0; i < 4; ++i) {
+        if (is(tokens, index, names[i])) {
+            value = static_cast<SwipeDirection>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *statusName(BFSStatus status) {
+    switch (status) {
+    case BFSStatus::CONNECTED:
+        return "connected";
+    case BFSStatus::LEAKAGE:
+        return "leakage";
+    default:
+        return "stuck";
+    }
+}
+
+GameSession *findSession(Connection &connection, const Tokens &tokens, string &reply) {
+    unsigned long long id;
+    if (tokens.count < 2 || !number(tokens, 1, id)) {
+        reply += "err missing session\n";
+        return nullptr;
+    }
+    unordered_map<uint32_t, GameSession>::iterator found = connection.sessions.find(static_cast<uint32_t>(id));
+    if (found == connection.sessions.end()) {
+        reply += "err no such session\n";
+        return nullptr;
+    }
+    return &found->second;
+}
+
+void runCommand(const Server &server, Connection &connection, const char *line, size_t length, string &reply) {
+    Tokens tokens;
+    if (!split(line, length, tokens)) {
+        reply += "err line too long\n";
+        return;
+    }
+    if (tokens.count == 0) {
+        reply += "err empty command\n";
+        return;
+    }
+
+    char buffer[64];
+    if (is(tokens, 0, "new")) {
+        unsigned long long level = 0, seed = connection.nextId;
+        if (tokens.count >= 2 && is(tokens, 1, "feature")) {
+            if (tokens.count >= 3 && !number(tokens, 2, seed)) {
+                reply += "err bad seed\n";
+                return;
+            }
+            Random random(seed);
+            Board start = featureBoard(Board::DEFAULT_SIZE, random);
+            connection.sessions.emplace(connection.nextId, GameSession(start, random.get_state(), GameSession::SPAWNS));
+        } else {
+            Board loaded;
+            if (tokens.count < 2 || !number(tokens, 1, level) || !server.levels
+                    || level < 1 || level > static_cast<unsigned long long>(server.levels->get_count())
+                    || !server.levels->load_level(static_cast<int>(level), loaded)) {
+                reply += "err no such level\n";
+                return;
+            }
+            connection.sessions.emplace(connection.nextId, GameSession(loaded, 0, 0));
+        }
+        snprintf(buffer, sizeof(buffer), "ok %u\n", connection.nextId++);
+        reply += buffer;
+    } else if (is(tokens, 0, "rotate")) {
+        GameSession *session = findSession(connection, tokens, reply);
+        if (session == nullptr) return;
+        if (tokens.count < 4 || tokens.count % 2 != 0) {
+            reply += "err rotate needs y x pairs\n";
+            return;
+        }
+        // Every pair before a bad one still counts, like clicks
+        for (int i = 2; i < tokens.count; i += 2) {
+            unsigned long long y, x;
+            if (!number(tokens, i, y) || !number(tokens, i + 1, x) || y > 1 << 16 || x > 1 << 16
+                    || !session->rotate(static_cast<int>(y), static_cast<int>(x))) {
+                reply += "err no such block\n";
+                return;
+            }
+        }
+        snprintf(buffer, sizeof(buffer), "ok %d\n", session->get_steps());
+        reply += buffer;
+    } else if (is(tokens, 0, "swipe")) {
+        GameSession *session = findSession(connection, tokens, reply);
+        if (session == nullptr) return;
+        if (!(session->get_flags() & GameSession::SPAWNS)) {
+            reply += "err not a feature game\n";
+            return;
+        }
+        if (tokens.count < 3) {
+            reply += "err swipe needs a direction\n";
+            return;
+        }
+        int spawned = -1;
+        for (int i = 2; i < tokens.count; ++i) {
+            SwipeDirection value;
+            if (!direction(tokens, i, value)) {
+                reply += "err bad direction\n";
+                return;
+            }
+            spawned = session->swipe(value);
+        }
+        snprintf(buffer, sizeof(buffer), "ok %d\n", spawned);
+        reply += buffer;
+    } else if (is(tokens, 0, "evaluate")) {
+        GameSession *session = findSession(connection, tokens, reply);
+        if (session == nullptr) return;
+        BFSResult result = session->evaluate();
+        snprintf(buffer, sizeof(buffer), "ok %s %d\n", statusName(result.status), result.cycles);
+        reply += buffer;
+    } else if (is(tokens, 0, "snapshot")) {
+        static const char digits[] = "0123456789abcdefghijklmnopqrstuv";
+        GameSession *session = findSession(connection, tokens, reply);
+        if (session == nullptr) return;
+        const Board &board = session->get_board();
+        snprintf(buffer, sizeof(buffer), "ok %d %d %d ", session->get_steps(), board.get_height(), board.get_width());
+        reply += buffer;
+        const unsigned char *cells = board.get_cells();
+        for (int i = 0; i < board.get_height() * board.get_width(); ++i) {
+            reply += digits[cells[i]];
+        }
+        reply += '\n';
+    } else if (is(tokens, 0, "close")) {
+        if (findSession(connection, tokens, reply) == nullptr) return;
+        unsigned long long id;
+        number(tokens, 1, id);
+        connection.sessions.erase(static_cast<uint32_t>(id));
+        reply += "ok\n";
+    } else {
+        reply += "err unknown command\n";
+    }
+}
+
+// Runs every complete line of `batch` on a worker
+string runBatch(const Server &server, Connection &connection, const string &batch) {
+    string reply;
+    size_t start = 0;
+    while (start < batch.size()) {
+        size_t end = batch.find('\n', start);
+        if (end == string::npos) end = batch.size();
+        runCommand(server, connection, batch.data() + start, end - start, reply);
+        start = end + 1;
+    }
+    return reply;
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+int listenOn(const string &path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+}
+
+// The event loop: one thread owns every file descriptor and connection,
+// workers only run batches and hand the replies back through `wake`
+class EventLoop
+{
+ public:
+    EventLoop(const Server &_server, int threads):
+        server(_server),
+        pool(threads),
+        events(epoll_create1(EPOLL_CLOEXEC)),
+        wake(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        listener(-1),
+        signals(-1),
+        stopping(false),
+        nextConnection(1)
+    {
+        this->watch(this->wake, 0, EPOLLIN);
+    }
+
+    ~EventLoop()
+    {
+        this->pool.wait();
+        for (unordered_map<int, unique_ptr<Connection> >::iterator it = this->connections.begin();
+             it != this->connections.end(); ++it) {
+            if (it->second->in > 2) close(it->second->in);
+        }
+        if (this->listener >= 0) close(this->listener);
+        if (this->signals >= 0) close(this->signals);
+        close(this->wake);
+        close(this->events);
+    }
+
+    bool is_valid() const {
+        return this->events >= 0 && this->wake >= 0;
+    }
+
+    void serve_stdin() {
+        int key = this->add(STDIN_FILENO, STDOUT_FILENO);
+        setNonBlocking(STDIN_FILENO);
+        if (!this->watch(STDIN_FILENO, key, EPOLLIN | EPOLLET)) {
+            // epoll refuses regular files, which never block anyway
+            this->connections[key]->pollable = false;
+        }
+        // Only needed when stdout shares the non-blocking terminal or socket
+        this->watch(STDOUT_FILENO, key, EPOLLOUT | EPOLLET);
+    }
+
+    // `stop` must be blocked in every thread, the workers included
+    bool serve_socket(int fd, const sigset_t &stop) {
+        this->listener = fd;
+        this->signals = signalfd(-1, &stop, SFD_NONBLOCK | SFD_CLOEXEC);
+        return this->signals >= 0 && this->watch(fd, LISTENER, EPOLLIN) && this->watch(this->signals, SIGNALS, EPOLLIN);
+    }
+
+    void run() {
+        epoll_event ready[64];
+        while (!this->stopping) {
+            bool polling = false;
+            for (unordered_map<int, unique_ptr<Connection> >::iterator it = this->connections.begin();
+                 it != this->connections.end(); ++it) {
+                Connection &connection = *it->second;
+                if (!connection.pollable && !connection.ended && !connection.busy) polling = true;
+            }
+            if (this->listener < 0 && this->connections.empty()) break;
+
+            int count = epoll_wait(this->events, ready, 64, polling ? 0 : -1);
+            if (count < 0 && errno != EINTR) break;
+            for (int i = 0; i < count; ++i) {
+                int key = static_cast<int>(ready[i].data.u64);
+                if (key == 0) {
+                    this->collect();
+                } else if (key == LISTENER) {
+                    this->accept_all();
+                } else if (key == SIGNALS) {
+                    this->stopping = true;
+                } else {
+                    unordered_map<int, unique_ptr<Connection> >::iterator found = this->connections.find(key);
+                    if (found == this->connections.end()) continue;
+                    // Writing may make room for reading more
+                    if (ready[i].events & EPOLLOUT) this->flush(*found->second);
+                    this->receive(key, *found->second);
+                }
+            }
+            for (unordered_map<int, unique_ptr<Connection> >::iterator it = this->connections.begin();
+                 it != this->connections.end(); ++it) {
+                if (!it->second->pollable) this->receive(it->first, *it->second);
+            }
+            this->close_finished();
+        }
+    }
+
+ private:
+    static const int LISTENER = -1;
+    static const int SIGNALS = -2;
+
+    struct Finished {
+        int key;
+        string reply;
+    };
+
+    const Server &server;
+    ThreadPool pool;
+    int events;
+    int wake;
+    int listener;
+    int signals;
+    bool stopping;
+    int nextConnection;
+    unordered_map<int, unique_ptr<Connection> > connections;
+    mutex guard;
+    deque<Finished> finished;
+
+    bool watch(int fd, int key, uint32_t flags) {
+        epoll_event event;
+        event.events = flags;
+        event.data.u64 = static_cast<uint64_t>(static_cast<int64_t>(key));
+        return epoll_ctl(this->events, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    int add(int in, int out) {
+        unique_ptr<Connection> connection(new Connection());
+        connection->in = in;
+        connection->out = out;
+        connection->pollable = true;
+        connection->ended = false;
+        connection->busy = false;
+        connection->nextId = 1;
+        this->connections[this->nextConnection] = move(connection);
+        return this->nextConnection++;
+    }
+
+    void accept_all() {
+        while (true) {
+            int fd = accept4(this->listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int key = this->add(fd, fd);
+            if (!this->watch(fd, key, EPOLLIN | EPOLLOUT | EPOLLET)) {
+                close(fd);
+                this->connections.erase(key);
+            }
+        }
+    }
+
+    void receive(int key, Connection &connection) {
+        // A client with replies piling up is not read until it catches up
+        while (!connection.ended && connection.output.size() < OUTPUT_LIMIT
+               && connection.input.size() < OUTPUT_LIMIT) {
+            char chunk[READ_CHUNK];
+            ssize_t count = read(connection.in, chunk, sizeof(chunk));
+            if (count > 0) {
+                connection.input.append(chunk, static_cast<size_t>(count));
+                if (!connection.pollable) break;
+            } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                connection.ended = true;
+                // The last line may lack its newline
+                if (!connection.input.empty() && connection.input.back() != '\n') connection.input += '\n';
+            } else if (errno != EINTR) {
+                break;
+            }
+        }
+        this->dispatch(key, connection);
+    }
+
+    void dispatch(int key, Connection &connection) {
+        if (connection.busy || connection.output.size() >= OUTPUT_LIMIT) return;
+        size_t end = connection.input.rfind('\n');
+        if (end == string::npos) {
+            if (connection.input.size() >= OUTPUT_LIMIT) {
+                connection.input.clear();
+                connection.output += "err line too long\n";
+                this->flush(connection);
+            }
+            return;
+        }
+
+        // Everything that arrived so far is one task
+        shared_ptr<string> batch = make_shared<string>(connection.input, 0, end + 1);
+        connection.input.erase(0, end + 1);
+        connection.busy = true;
+        Connection *target = &connection;
+        this->pool.run([this, key, target, batch]() {
+            Finished done = {key, runBatch(this->server, *target, *batch)};
+            {
+                lock_guard<mutex> lock(this->guard);
+                this->finished.push_back(move(done));
+            }
+            uint64_t one = 1;
+            ssize_t written = write(this->wake, &one, sizeof(one));
+            (void) written;
+        });
+    }
+
+    void collect() {
+        uint64_t value;
+        ssize_t count = read(this->wake, &value, sizeof(value));
+        (void) count;
+        deque<Finished> done;
+        {
+            lock_guard<mutex> lock(this->guard);
+            done.swap(this->finished);
+        }
+        for (size_t i = 0; i < done.size(); ++i) {
+            Connection &connection = *this->connections[done[i].key];
+            connection.busy = false;
+            connection.output += done[i].reply;
+            this->flush(connection);
+            // Reading stopped at the limits, and edge triggering will not say so again
+            if (connection.pollable) {
+                this->receive(done[i].key, connection);
+            } else {
+                this->dispatch(done[i].key, connection);
+            }
+        }
+    }
+
+    void flush(Connection &connection) {
+        size_t sent = 0;
+        while (sent < connection.output.size()) {
+            ssize_t count = write(connection.out, connection.output.data() + sent, connection.output.size() - sent);
+            if (count > 0) {
+                sent += static_cast<size_t>(count);
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    // The client is gone, drop whatever it would still have got
+                    connection.ended = true;
+                    connection.input.clear();
+                    sent = connection.output.size();
+                }
+                break;
+            }
+        }
+        connection.output.erase(0, sent);
+    }
+
+    void close_finished() {
+        for (unordered_map<int, unique_ptr<Connection> >::iterator it = this->connections.begin();
+             it != this->connections.end();) {
+            Connection &connection = *it->second;
+            if (connection.ended && !connection.busy && connection.output.empty()
+                    && connection.input.find('\n') == string::npos) {
+                if (connection.in > 2) close(connection.in);
+                it = this->connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    EventLoop(const EventLoop &);
+    EventLoop &operator=(const EventLoop &);
+};
+
+int main(int argc, char *argv[])
+{
+    string socketPath;
+    string levelsPath;
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (option == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (option.compare(0, 2, "--") == 0 || !levelsPath.empty()) {
+            usage(argv[0]);
+            return 2;
+        } else {
+            levelsPath = option;
+        }
+    }
+
+    // A client closing early must not end the server
+    signal(SIGPIPE, SIG_IGN);
+
+    Server server;
+    if (!levelsPath.empty()) {
+        ParseError error;
+        server.levels = openLevels(levelsPath, &error);
+        if (!server.levels) {
+            fprintf(stderr, "%s:%d:%d: %s\n", levelsPath.c_str(), error.line, error.column, error.message.c_str());
+            return 1;
+        }
+    }
+
+    // Ctrl+C and kill end the loop, so the socket file is removed
+    sigset_t stop;
+    sigemptyset(&stop);
+    sigaddset(&stop, SIGINT);
+    sigaddset(&stop, SIGTERM);
+    if (!socketPath.empty()) sigprocmask(SIG_BLOCK, &stop, nullptr);
+
+    EventLoop loop(server, threads);
+    if (!loop.is_valid()) {
+        perror("epoll");
+        return 1;
+    }
+    if (socketPath.empty()) {
+        loop.serve_stdin();
+    } else {
+        int fd = listenOn(socketPath);
+        if (fd < 0 || !loop.serve_socket(fd, stop)) {
+            perror(socketPath.c_str());
+            if (fd >= 0) close(fd);
+            return 1;
+        }
+    }
+    loop.run();
+    if (!socketPath.empty()) unlink(socketPath.c_str());
+    return 0;
+}
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Serves headless games over stdin or a Unix socket
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+TARGET = pipesserver
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
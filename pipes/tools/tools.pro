@@ -0,0 +1,10 @@
+TEMPLATE = subdirs
+
+SUBDIRS = mapconvert \
+    levelgen \
+    pipesbot \
+    pipesreplay \
+    levelcount
+
+# epoll and Unix sockets
+linux: SUBDIRS += pipesserver